@@ -0,0 +1,396 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "atheepmgr.h"
+#include "utils.h"
+#include "container.h"
+
+/**
+ * Delta archive file layout (all fields are little-endian):
+ *
+ *   header (struct arch_hdr)
+ *   diff data
+ *
+ * The archived image is the raw EEPROM dump as it is written by the save
+ * action. The image is stored as a difference against a reference image,
+ * which could be: an empty (0xff filled) EEPROM or a golden image file,
+ * which is identified by its hash. AR93xx templates are not used as
+ * references, since the raw AR93xx image is a set of compressed blocks,
+ * which are already stored as a difference against a template. The difference is encoded in the same
+ * way as the AR93xx compressed block data: a sequence of the (offset,
+ * length, data) records, where the offset is counted from the end of the
+ * previous record and the zero length record just advances the position.
+ */
+
+#define ARCH_MAGIC		"AEMD"
+#define ARCH_MAGIC_LEN		4
+#define ARCH_VERSION		1
+
+#define ARCH_F_IO_SWAP		0x01	/* EEPROM data are stored byteswapped */
+
+enum arch_ref_type {
+	ARCH_REF_FILL,			/* Empty EEPROM */
+	ARCH_REF_GOLDEN,		/* Golden image file */
+};
+
+struct arch_hdr {
+	char magic[ARCH_MAGIC_LEN];
+	uint8_t version;
+	uint8_t flags;
+	uint8_t ref_type;		/* Reference image type */
+	uint8_t reserved0;
+	char eepmap[8];			/* EEPROM map name */
+	uint32_t mac_version;
+	uint16_t mac_rev;
+	uint16_t reserved;
+	uint64_t ref_hash;		/* Golden image hash */
+	uint64_t hash;			/* Archived image hash */
+	uint32_t img_len;		/* Image length, bytes */
+	uint32_t diff_len;		/* Diff data length, bytes */
+} __attribute__ ((packed));
+
+#define ARCH_GAP_MIN		3	/* Minimal gap length to split a record */
+#define ARCH_REC_MAX		0xff	/* Maximal record offset & length */
+
+struct arch_ref {
+	enum arch_ref_type type;
+	uint64_t hash;
+	const uint8_t *data;
+	size_t len;
+};
+
+static inline uint8_t arch_ref_byte(const struct arch_ref *ref, size_t pos)
+{
+	return pos < ref->len ? ref->data[pos] : 0xff;
+}
+
+/* Encode image difference against the reference, returns diff length */
+static size_t arch_diff_encode(const struct arch_ref *ref, const uint8_t *img,
+			       size_t len, uint8_t *out)
+{
+	size_t i, start, end, gap, spot = 0, olen = 0;
+
+	for (i = 0; i < len; ) {
+		if (img[i] == arch_ref_byte(ref, i)) {
+			i++;
+			continue;
+		}
+
+		start = i;
+		for (end = start; end < len && end - start < ARCH_REC_MAX; ) {
+			if (img[end] != arch_ref_byte(ref, end)) {
+				end++;
+				continue;
+			}
+			for (gap = end; gap < len && gap - end < ARCH_GAP_MIN &&
+			     img[gap] == arch_ref_byte(ref, gap); ++gap);
+			if (gap == len || gap - end >= ARCH_GAP_MIN ||
+			    gap - start >= ARCH_REC_MAX)
+				break;
+			end = gap;	/* Merge short gap into the record */
+		}
+
+		for (; start - spot > ARCH_REC_MAX; spot += ARCH_REC_MAX) {
+			out[olen++] = ARCH_REC_MAX;
+			out[olen++] = 0;
+		}
+		out[olen++] = start - spot;
+		out[olen++] = end - start;
+		memcpy(&out[olen], &img[start], end - start);
+		olen += end - start;
+
+		spot = end;
+		i = end;
+	}
+
+	return olen;
+}
+
+static int arch_diff_decode(const struct arch_ref *ref, const uint8_t *diff,
+			    size_t dlen, uint8_t *img, size_t len)
+{
+	size_t i, spot = 0, rlen;
+
+	for (i = 0; i < len; ++i)
+		img[i] = arch_ref_byte(ref, i);
+
+	for (i = 0; i + 1 < dlen; i += rlen + 2) {
+		spot += diff[i];
+		rlen = diff[i + 1];
+		if (spot + rlen > len || i + 2 + rlen > dlen) {
+			fprintf(stderr, "Bad archive record at %zu: spot=%zu length=%zu\n",
+				i, spot, rlen);
+			return -EINVAL;
+		}
+		memcpy(&img[spot], &diff[i + 2], rlen);
+		spot += rlen;
+	}
+
+	return 0;
+}
+
+static int arch_golden_load(const char *fname, struct arch_ref *ref)
+{
+	struct cont_info info;
+	uint16_t *buf;
+	size_t len;
+	int ret;
+
+	ret = cont_load_image(fname, &info, &buf, &len);
+	if (ret)
+		return ret;
+
+	ref->type = ARCH_REF_GOLDEN;
+	ref->data = (uint8_t *)buf;
+	ref->len = len * sizeof(uint16_t);
+	ref->hash = fnv1a64(FNV1A64_INIT, ref->data, ref->len);
+
+	return 0;
+}
+
+static const char *arch_ref_str(const struct arch_ref *ref, char *buf,
+				size_t bufsz)
+{
+	switch (ref->type) {
+	case ARCH_REF_FILL:
+		return "empty EEPROM";
+	case ARCH_REF_GOLDEN:
+		snprintf(buf, bufsz, "golden image %016llx",
+			 (unsigned long long)ref->hash);
+		return buf;
+	}
+
+	return "unknown";
+}
+
+int act_eep_archive(struct atheepmgr *aem, int argc, char *argv[])
+{
+	const uint8_t *img = (uint8_t *)aem->eep_buf;
+	size_t len = aem->eep_len * sizeof(uint16_t);
+	struct arch_ref *refs, *best = NULL;
+	uint8_t *diff = NULL, *bdiff = NULL;
+	size_t dlen, bdlen = 0;
+	struct arch_hdr hdr;
+	int i, nrefs = 0, ret;
+	char buf[0x40];
+	FILE *fp;
+
+	if (!aem->eepmap->eep_buf_sz) {
+		fprintf(stderr, "EEPROM map does not support buffered operation, so the content archiving is not possible\n");
+		return -EOPNOTSUPP;
+	}
+
+	if (argc < 1) {
+		fprintf(stderr, "Output file for EEPROM archiving is not specified, aborting\n");
+		return -EINVAL;
+	}
+
+	/* Empty EEPROM + golden images */
+	refs = calloc(1 + argc - 1, sizeof(*refs));
+	diff = malloc(len * 3 + 1);
+	bdiff = malloc(len * 3 + 1);
+	if (!refs || !diff || !bdiff) {
+		fprintf(stderr, "Unable to allocate memory for archiving\n");
+		ret = -ENOMEM;
+		goto exit;
+	}
+
+	refs[nrefs++].type = ARCH_REF_FILL;
+	for (i = 1; i < argc; ++i) {
+		ret = arch_golden_load(argv[i], &refs[nrefs]);
+		if (ret)
+			goto exit;
+		nrefs++;
+	}
+
+	for (i = 0; i < nrefs; ++i) {
+		dlen = arch_diff_encode(&refs[i], img, len, diff);
+		if (aem->verbose)
+			printf("Reference %s: %zu bytes diff\n",
+			       arch_ref_str(&refs[i], buf, sizeof(buf)), dlen);
+		if (best && dlen >= bdlen)
+			continue;
+		best = &refs[i];
+		bdlen = dlen;
+		memcpy(bdiff, diff, dlen);
+	}
+
+	memset(&hdr, 0x00, sizeof(hdr));
+	memcpy(hdr.magic, ARCH_MAGIC, ARCH_MAGIC_LEN);
+	hdr.version = ARCH_VERSION;
+	hdr.flags = aem->eep_io_swap ? ARCH_F_IO_SWAP : 0;
+	hdr.ref_type = best->type;
+	memcpy(hdr.eepmap, aem->eepmap->name,
+	       strnlen(aem->eepmap->name, sizeof(hdr.eepmap)));
+	hdr.mac_version = htole32(aem->macVersion);
+	hdr.mac_rev = htole16(aem->macRev);
+	hdr.ref_hash = htole64(best->hash);
+	hdr.hash = htole64(fnv1a64(FNV1A64_INIT, img, len));
+	hdr.img_len = htole32(len);
+	hdr.diff_len = htole32(bdlen);
+
+	fp = fopen(argv[0], "wb");
+	if (!fp) {
+		fprintf(stderr, "Unable to open output file for writing: %s\n",
+			strerror(errno));
+		ret = -errno;
+		goto exit;
+	}
+	if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1 ||
+	    fwrite(bdiff, 1, bdlen, fp) != bdlen) {
+		fprintf(stderr, "Unable to save EEPROM archive: %s\n",
+			strerror(errno));
+		ret = -EIO;
+	} else {
+		printf("Archived %zu bytes image as %zu bytes diff against %s\n",
+		       len, bdlen, arch_ref_str(best, buf, sizeof(buf)));
+		ret = 0;
+	}
+	fclose(fp);
+
+exit:
+	if (refs)
+		for (i = 0; i < nrefs; ++i)
+			if (refs[i].type == ARCH_REF_GOLDEN)
+				free((void *)refs[i].data);
+	free(refs);
+	free(diff);
+	free(bdiff);
+
+	return ret;
+}
+
+int act_eep_unarchive(struct atheepmgr *aem, int argc, char *argv[])
+{
+	struct arch_ref ref = {.type = ARCH_REF_FILL};
+	uint8_t *diff = NULL, *img = NULL;
+	size_t len, dlen;
+	struct arch_hdr hdr;
+	char name[sizeof(hdr.eepmap) + 1];
+	char buf[0x40];
+	FILE *fp;
+	int i, ret;
+
+	if (argc < 2) {
+		fprintf(stderr, "Archive and output files should be specified, aborting\n");
+		return -EINVAL;
+	}
+
+	fp = fopen(argv[0], "rb");
+	if (!fp) {
+		fprintf(stderr, "Unable to open archive file '%s': %s\n",
+			argv[0], strerror(errno));
+		return -errno;
+	}
+
+	if (fread(&hdr, sizeof(hdr), 1, fp) != 1 ||
+	    memcmp(hdr.magic, ARCH_MAGIC, ARCH_MAGIC_LEN) != 0 ||
+	    hdr.version != ARCH_VERSION) {
+		fprintf(stderr, "Invalid or unsupported archive file\n");
+		fclose(fp);
+		return -EINVAL;
+	}
+
+	len = le32toh(hdr.img_len);
+	dlen = le32toh(hdr.diff_len);
+	/* NB: archiving produces up to 3 bytes of diff per image byte */
+	if (len > eepmap_max_buf_sz() * sizeof(uint16_t) || dlen > len * 3 + 1) {
+		fprintf(stderr, "Invalid archive image length %zu (diff %zu)\n",
+			len, dlen);
+		fclose(fp);
+		return -EINVAL;
+	}
+	diff = malloc(dlen + 1);
+	img = malloc(len + 1);
+	if (!diff || !img) {
+		fprintf(stderr, "Unable to allocate memory for unarchiving\n");
+		ret = -ENOMEM;
+		fclose(fp);
+		goto exit;
+	}
+	if (fread(diff, 1, dlen, fp) != dlen) {
+		fprintf(stderr, "Unexpected end of archive file\n");
+		ret = -EIO;
+		fclose(fp);
+		goto exit;
+	}
+	fclose(fp);
+
+	ref.type = hdr.ref_type;
+	ref.hash = le64toh(hdr.ref_hash);
+	if (hdr.ref_type == ARCH_REF_GOLDEN) {
+		for (i = 2; i < argc; ++i) {
+			ret = arch_golden_load(argv[i], &ref);
+			if (ret)
+				goto exit;
+			if (ref.hash == le64toh(hdr.ref_hash))
+				break;
+			free((void *)ref.data);
+			ref.data = NULL;
+		}
+		if (!ref.data) {
+			fprintf(stderr, "Golden image %016llx is not found\n",
+				(unsigned long long)le64toh(hdr.ref_hash));
+			ret = -ENOENT;
+			goto exit;
+		}
+	} else if (hdr.ref_type != ARCH_REF_FILL) {
+		fprintf(stderr, "Unknown reference type %u\n", hdr.ref_type);
+		ret = -EINVAL;
+		goto exit;
+	}
+
+	ret = arch_diff_decode(&ref, diff, dlen, img, len);
+	if (ret)
+		goto exit;
+
+	if (fnv1a64(FNV1A64_INIT, img, len) != le64toh(hdr.hash)) {
+		fprintf(stderr, "Restored image hash mismatch\n");
+		ret = -EINVAL;
+		goto exit;
+	}
+
+	fp = fopen(argv[1], "wb");
+	if (!fp) {
+		fprintf(stderr, "Unable to open output file for writing: %s\n",
+			strerror(errno));
+		ret = -errno;
+		goto exit;
+	}
+	if (fwrite(img, 1, len, fp) != len) {
+		fprintf(stderr, "Unable to save EEPROM contents: %s\n",
+			strerror(errno));
+		ret = -EIO;
+	}
+	fclose(fp);
+	if (ret)
+		goto exit;
+
+	memcpy(name, hdr.eepmap, sizeof(hdr.eepmap));
+	name[sizeof(hdr.eepmap)] = '\0';
+	printf("Restored %zu bytes %s EEPROM image (MAC ver 0x%x rev 0x%x%s) from %s\n",
+	       len, name, le32toh(hdr.mac_version), le16toh(hdr.mac_rev),
+	       hdr.flags & ARCH_F_IO_SWAP ? ", byteswapped" : "",
+	       arch_ref_str(&ref, buf, sizeof(buf)));
+
+exit:
+	if (ref.type == ARCH_REF_GOLDEN)
+		free((void *)ref.data);
+	free(diff);
+	free(img);
+
+	return ret;
+}
@@ -17,6 +17,8 @@
 
 #include "atheepmgr.h"
 #include "utils.h"
+#include "container.h"
+#include "trace.h"
 
 static struct atheepmgr __aem;
 
@@ -28,7 +30,7 @@ static const struct eepmap * const eepmaps[] = {
 	&eepmap_9300,
 };
 
-static const struct eepmap *eepmap_find_by_name(const char *name)
+const struct eepmap *eepmap_find_by_name(const char *name)
 {
 	int i;
 
@@ -40,7 +42,20 @@ static const struct eepmap *eepmap_find_by_name(const char *name)
 	return NULL;
 }
 
-static int eepmap_detect(struct atheepmgr *aem)
+/* Biggest EEPROM buffer among all maps, words */
+size_t eepmap_max_buf_sz(void)
+{
+	size_t sz = 0;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(eepmaps); ++i)
+		if (eepmaps[i]->eep_buf_sz > sz)
+			sz = eepmaps[i]->eep_buf_sz;
+
+	return sz;
+}
+
+int eepmap_detect(struct atheepmgr *aem)
 {
 	if (AR_SREV_9300_20_OR_LATER(aem)) {
 		aem->eepmap = &eepmap_9300;
@@ -63,6 +78,34 @@ static int eepmap_detect(struct atheepmgr *aem)
 	return 0;
 }
 
+bool eepmap_fill(struct atheepmgr *aem)
+{
+	bool res;
+
+	aem->rd_num = 0;	/* Pace and account each fill separately */
+
+	TRACE_PROBE1(eep_fill_enter, aem->eepmap->name);
+	trace_begin(aem, "fill_eeprom", aem->eepmap->name);
+	res = aem->eepmap->fill_eeprom(aem);
+	trace_end(aem, "fill_eeprom", res);
+	TRACE_PROBE2(eep_fill_exit, aem->eepmap->name, res);
+
+	return res;
+}
+
+int eepmap_check(struct atheepmgr *aem)
+{
+	int res;
+
+	TRACE_PROBE1(eep_check_enter, aem->eepmap->name);
+	trace_begin(aem, "check_eeprom", aem->eepmap->name);
+	res = aem->eepmap->check_eeprom(aem);
+	trace_end(aem, "check_eeprom", res);
+	TRACE_PROBE2(eep_check_exit, aem->eepmap->name, res);
+
+	return res;
+}
+
 static const struct eepmap_section {
 	const char *name;
 	const char *desc;
@@ -157,6 +200,13 @@ static int act_eep_save(struct atheepmgr *aem, int argc, char *argv[])
 		return -EINVAL;
 	}
 
+	if (argc > 1 && strcasecmp(argv[1], "aem") == 0) {
+		return cont_save(aem, argv[0]);
+	} else if (argc > 1 && strcasecmp(argv[1], "raw") != 0) {
+		fprintf(stderr, "Unknown EEPROM saving format -- %s\n", argv[1]);
+		return -EINVAL;
+	}
+
 	fp = fopen(argv[0], "wb");
 	if (!fp) {
 		fprintf(stderr, "Unable to open output file for writing: %s\n",
@@ -260,7 +310,9 @@ static int act_eep_update(struct atheepmgr *aem, int argc, char *argv[])
 
 	EEP_UNLOCK();
 
+	TRACE_PROBE1(eep_update_enter, param->id);
 	res = eepmap->update_eeprom(aem, param->id, data);
+	TRACE_PROBE2(eep_update_exit, param->id, res);
 
 	EEP_LOCK();
 
@@ -272,6 +324,7 @@ static int act_gpio_dump(struct atheepmgr *aem, int argc, char *argv[])
 #define FOR_EACH_GPIO(_caption)				\
 		printf("%20s:", _caption);		\
 		for (i = 0; i < aem->gpio_num; ++i)
+	struct gpio_state st;
 	int i;
 
 	if (!aem->gpio) {
@@ -279,22 +332,24 @@ static int act_gpio_dump(struct atheepmgr *aem, int argc, char *argv[])
 		return -EOPNOTSUPP;
 	}
 
+	aem->gpio->state_get(aem, &st);
+
 	FOR_EACH_GPIO("GPIO #")
 		printf(" %-3u", i);
 	printf("\n");
 	FOR_EACH_GPIO("Direction")
-		printf(" %-3s", aem->gpio->dir_get_str(aem, i));
+		printf(" %-3s", st.dir[i]);
 	printf("\n");
-	if (aem->gpio->out_mux_get_str) {
+	if (st.out_mux[0]) {
 		FOR_EACH_GPIO("Output mux")
-			printf(" %-3s", aem->gpio->out_mux_get_str(aem, i));
+			printf(" %-3s", st.out_mux[i]);
 		printf("\n");
 	}
 	FOR_EACH_GPIO("Input value")
-		printf(" %c  ", aem->gpio->input_get(aem, i) ? '1' : ' ');
+		printf(" %c  ", st.in & BIT(i) ? '1' : ' ');
 	printf("\n");
 	FOR_EACH_GPIO("Output value")
-		printf(" %c  ", aem->gpio->output_get(aem, i) ? '1' : ' ');
+		printf(" %c  ", st.out & BIT(i) ? '1' : ' ');
 	printf("\n");
 
 	return 0;
@@ -356,9 +411,6 @@ static int act_reg_write(struct atheepmgr *aem, int argc, char *argv[])
 	return 0;
 }
 
-#define ACT_F_EEPROM	(1 << 0)	/* Action will interact with EEPROM */
-#define ACT_F_HW	(1 << 1)	/* Action require direct HW access */
-
 static const struct action {
 	const char *name;
 	int (*func)(struct atheepmgr *aem, int argc, char *argv[]);
@@ -371,15 +423,19 @@ static const struct action {
 	}, {
 		.name = "save",
 		.func = act_eep_save,
-		.flags = ACT_F_EEPROM,
+		.flags = ACT_F_EEPROM | ACT_F_NOSRV,
 	}, {
 		.name = "update",
 		.func = act_eep_update,
-		.flags = ACT_F_EEPROM,
+		.flags = ACT_F_EEPROM | ACT_F_EEPWR,
 	}, {
 		.name = "gpiodump",
 		.func = act_gpio_dump,
 		.flags = ACT_F_HW,
+	}, {
+		.name = "gpiowatch",
+		.func = act_gpio_watch,
+		.flags = ACT_F_HW | ACT_F_NOSRV,
 	}, {
 		.name = "regread",
 		.func = act_reg_read,
@@ -387,25 +443,135 @@ static const struct action {
 	}, {
 		.name = "regwrite",
 		.func = act_reg_write,
-		.flags = ACT_F_HW,
-	}
+		.flags = ACT_F_HW | ACT_F_NOSRV,
+	}, {
+		.name = "regdump",
+		.func = act_reg_dump,
+		.flags = ACT_F_HW | ACT_F_NOSRV,
+	}, {
+		.name = "regdiff",
+		.func = act_reg_diff,
+		.flags = ACT_F_NOCON,
+	}, {
+		.name = "regscript",
+		.func = act_reg_script,
+		.flags = ACT_F_HW | ACT_F_NOSRV,
+	}, {
+		.name = "extract",
+		.func = act_eep_extract,
+		.flags = ACT_F_NOCON,
+	}, {
+		.name = "archive",
+		.func = act_eep_archive,
+		.flags = ACT_F_EEPROM | ACT_F_NOSRV,
+	}, {
+		.name = "unarchive",
+		.func = act_eep_unarchive,
+		.flags = ACT_F_NOCON,
+	}, {
+		.name = "restore",
+		.func = act_eep_restore,
+		.flags = ACT_F_EEPIO | ACT_F_EEPWR | ACT_F_NOSRV,
+	}, {
+		.name = "verify",
+		.func = act_eep_verify,
+		.flags = ACT_F_EEPIO | ACT_F_NOSRV,
+	}, {
+		.name = "patch",
+		.func = act_eep_patch,
+		.flags = ACT_F_NOCON,
+	}, {
+		.name = "watch",
+		.func = act_eep_watch,
+		.flags = ACT_F_EEPROM | ACT_F_NOSRV,
+	}, {
+		.name = "probe",
+		.func = act_eep_probe,
+		.flags = ACT_F_EEPIO,
+	}, {
+		.name = "metrics",
+		.func = act_eep_metrics,
+		.flags = ACT_F_EEPIO | ACT_F_NOSRV,
+	}, {
+		.name = "serve",
+		.func = act_eep_serve,
+		.flags = ACT_F_EEPROM | ACT_F_NOSRV,
+	}, {
+		.name = "query",
+		.func = act_eep_query,
+		.flags = ACT_F_NOCON,
+	}, {
+		.name = "provision",
+		.func = act_eep_provision,
+		.flags = ACT_F_NOCON,
+	}, {
+		.name = "store",
+		.func = act_eep_store,
+		.flags = ACT_F_EEPROM | ACT_F_NOSRV,
+	}, {
+		.name = "storelist",
+		.func = act_eep_store_list,
+		.flags = ACT_F_NOCON,
+	}, {
+		.name = "storeget",
+		.func = act_eep_store_get,
+		.flags = ACT_F_NOCON,
+	},
+#if defined(CONFIG_BENCH)
+	{
+		.name = "bench",
+		.func = act_bench,
+		.flags = ACT_F_NOCON,
+	},
+#endif
 };
 
-#if defined(CONFIG_CON_PCI) && defined(CONFIG_CON_MEM)
-#define CON_OPTSTR	"F:M:P:"
-#define CON_USAGE	"{-F <eepdump> | -M <ioaddr> | -P <slot>}"
-#elif defined(CONFIG_CON_MEM)
-#define CON_OPTSTR	"F:M:"
-#define CON_USAGE	"{-F <eepdump> | -M <ioaddr>}"
-#elif defined(CONFIG_CON_PCI)
-#define CON_OPTSTR	"F:P:"
-#define CON_USAGE	"{-F <eepdump> | -P <slot>}"
+#if defined(CONFIG_CON_MEM)
+#define CON_OPTSTR_MEM	"M:"
+#define CON_USAGE_MEM	" | -M <ioaddr>"
+#else
+#define CON_OPTSTR_MEM	""
+#define CON_USAGE_MEM	""
+#endif
+
+#if defined(CONFIG_CON_PCI)
+#define CON_OPTSTR_PCI	"P:"
+#define CON_USAGE_PCI	" | -P <slot>"
+#else
+#define CON_OPTSTR_PCI	""
+#define CON_USAGE_PCI	""
+#endif
+
+#if defined(CONFIG_CON_SYSFS)
+#define CON_OPTSTR_SYSFS	"S:"
+#define CON_USAGE_SYSFS	" | -S <slot>"
+#else
+#define CON_OPTSTR_SYSFS	""
+#define CON_USAGE_SYSFS	""
+#endif
+
+#if defined(CONFIG_CON_DRIVER)
+#define CON_OPTSTR_DRIVER	"D:"
+#define CON_USAGE_DRIVER	" | -D <src>"
+#else
+#define CON_OPTSTR_DRIVER	""
+#define CON_USAGE_DRIVER	""
+#endif
+
+#define CON_OPTSTR	"F:" CON_OPTSTR_MEM CON_OPTSTR_PCI CON_OPTSTR_SYSFS \
+			CON_OPTSTR_DRIVER
+#define CON_USAGE	"{-F <eepdump>" CON_USAGE_MEM CON_USAGE_PCI \
+			CON_USAGE_SYSFS CON_USAGE_DRIVER "}"
+
+#if defined(__GLIBC__)
+#define OPTSTR_POSIX	"+"	/* Stop on the first action, do not permute */
 #else
-#define CON_OPTSTR	"F:"
-#define CON_USAGE	"-F <eepdump>"
+#define OPTSTR_POSIX	""
 #endif
 
-static const char *optstr = CON_OPTSTR "ht:v";
+static const char *optstr = OPTSTR_POSIX CON_OPTSTR "chr:T:t:v";
+
+#define ACT_CHAIN_SEP	"--"
 
 static void usage_eepmap(const struct eepmap *eepmap)
 {
@@ -449,12 +615,24 @@ static void usage(char *name)
 		"Copyright (c) 2013-2018, Sergey Ryazanov <ryazanov.s.a@gmail.com>\n"
 		"\n"
 		"Usage:\n"
-		"  %s " CON_USAGE " [-t <eepmap>] [<action> [<actarg>]]\n"
+		"  %s " CON_USAGE " [-t <eepmap>] [<action> [<actarg>]] [-- <action> [<actarg>]]...\n"
+		"or\n"
+		"  %s {extract <image> [<prefix>] | unarchive <arch> <file> [<golden>...] |\n"
+		"      storelist <dir> [<dev>] | storeget <dir> <dev> <file> |\n"
+		"      provision <pool> [<first>-<last>] <target>... |\n"
+		"      patch create <orig> <new> <patch> | regdiff <snap> <snap2>}\n"
 		"or\n"
 		"  %s -h\n"
 		"\n"
 		"Options:\n"
-		"  -F <eepdump>    Read EEPROM dump from <eepdump> file.\n"
+		"  -F <eepdump>[:<offset>[:<size>]]  Read EEPROM dump from <eepdump> file.\n"
+		"                  If <offset> is specified, then only the file window of\n"
+		"                  <size> bytes (up to the file end by default), which is\n"
+		"                  started at <offset>, is used as the EEPROM. This way the\n"
+		"                  EEPROM data could be accessed directly inside a flash\n"
+		"                  dump or an MTD partition. Writes are limited by window.\n"
+		"                  MTD devices are opened for reading only, since the flash\n"
+		"                  should be erased before writing.\n"
 #if defined(CONFIG_CON_MEM)
 		"  -M <ioaddr>     Interact with card via /dev/mem by mapping\n"
 		"                  card I/O memory at <ioaddr> to the process.\n"
@@ -467,6 +645,27 @@ static void usage(char *name)
 		"                  then domain 0 will be used. If <func> is omitted\n"
 		"                  then first available function will be used.\n"
 #endif
+#if defined(CONFIG_CON_SYSFS)
+		"  -S <slot>       Interact with card via the Linux sysfs PCI resource file\n"
+		"                  without the whole PCI bus scanning. Slot should be\n"
+		"                  specified in the same form as for -P (function 0 is\n"
+		"                  used if omitted) or as a path to the device sysfs\n"
+		"                  directory (e.g. /sys/bus/pci/devices/0000:01:00.0).\n"
+#endif
+#if defined(CONFIG_CON_DRIVER)
+		"  -D <src>        Fetch EEPROM image from the kernel driver without direct\n"
+		"                  HW access (read-only). <src> is a network interface name\n"
+		"                  to use the ethtool EEPROM dump or a path to a file, e.g.\n"
+		"                  a driver debugfs file or an image captured earlier.\n"
+#endif
+		"  -c              Cache non-volatile registers (e.g. GPIO configuration) to\n"
+		"                  avoid redundant accesses, useful for slow connectors.\n"
+		"  -r <rate>       Limit the EEPROM (OTP) reading rate to <rate> words per\n"
+		"                  second to reduce interference with the live driver. The\n"
+		"                  achieved rate is reported after the reading.\n"
+		"  -T <file>       Record the run timeline (connector and chip initialization,\n"
+		"                  EEPROM reading and parsing, actions) to the <file> in the\n"
+		"                  Chrome trace-event format (chrome://tracing, Perfetto).\n"
 		"  -t <eepmap>     Override EEPROM map type (see below), this option is required\n"
 		"                  for connectors, without direct HW access.\n"
 		"  -v              Be verbose.\n"
@@ -476,6 +675,10 @@ static void usage(char *name)
 		"                  the 'dump' action is performed by default.\n"
 		"  <actarg>        Action argument if the action accepts any (see details below\n"
 		"                  in the detailed actions list).\n"
+		"  -- <action>     Several actions separated by '--' are performed one by one\n"
+		"                  with the EEPROM content, which is read only once. Changes\n"
+		"                  made by an action are visible to the following actions.\n"
+		"                  Processing stops on the first failed action.\n"
 		"\n"
 		"Available actions:\n"
 		"  dump [<sects>]  Read & parse the EEPROM content and then dump it to the\n"
@@ -488,12 +691,138 @@ static void usage(char *name)
 		"                  and the second disables any dumping to the terminal.\n"
 		"                  The default action behaviour is to print the contents of all\n"
 		"                  supported EEPROM sections.\n"
-		"  save <file>     Save fetched raw EEPROM content to the file <file>.\n"
+		"  save <file> [<fmt>]  Save fetched raw EEPROM content to the file <file>.\n"
+		"                  Optional <fmt> argument selects the file format: 'raw' -\n"
+		"                  plain EEPROM words dump (default), 'aem' - compact container,\n"
+		"                  which keeps only non-empty data and carries the EEPROM map\n"
+		"                  type, chip revision and byteswapping state, so it could be\n"
+		"                  loaded by the file connector without the -t option.\n"
 		"  update <param>[=<val>]  Set EEPROM parameter <param> to <val>. See per-map\n"
 		"                  supported parameters list below.\n"
 		"  gpiodump        Dump GPIO lines state to the terminal.\n"
+		"  gpiowatch [rate=<Hz>] [time=<sec>] [mask=<mask>]  Sample GPIO inputs\n"
+		"                  with the specified rate (10 kHz by default, 0 - as fast as\n"
+		"                  possible) and print each level change of the <mask>\n"
+		"                  lines with its timestamp. Sampling continues for <time>\n"
+		"                  seconds or until interrupted by Ctrl-C.\n"
 		"  regread <addr>  Read register at address <addr> and print it value.\n"
 		"  regwrite <addr> <val> Write value <val> to the register at address <addr>.\n"
+		"  regdump {<start> <end> | all} <file>  Save the values of the registers\n"
+		"                  from <start> up to <end> (not included) or of the whole\n"
+		"                  mapped registers space to the <file> snapshot. Registers,\n"
+		"                  which reading has side effects (e.g. the EEPROM and OTP\n"
+		"                  windows or the read-and-clear interrupt status shadows),\n"
+		"                  are skipped.\n"
+		"  regdiff <snap> [<snap2>]  Print registers, which values differ in the\n"
+		"                  <snap> and <snap2> snapshots. If <snap2> is omitted, then\n"
+		"                  the <snap> is compared with the device registers.\n"
+		"  regscript [<file>]  Run the register access script from the <file> (or\n"
+		"                  from stdin if it is omitted or '-'). Each script line is\n"
+		"                  an operation: 'read <addr> [<var>]', 'write <addr> <val>',\n"
+		"                  'rmw <addr> <set> <clr>', 'wait <addr> <mask> <val> [<ms>]'\n"
+		"                  (wait for the masked register value, 1s timeout by\n"
+		"                  default), 'sleep <ms>', 'set <var> <a> [<op> <b>]' (where\n"
+		"                  <op> is one of: & | ^ + - << >>) and 'print <text>'.\n"
+		"                  Arguments are C-style numbers or $<var> variables, which\n"
+		"                  are also substituted in the print text. The '#' starts a\n"
+		"                  comment. The whole script is checked before execution.\n"
+		"  extract <image> [<prefix>]  Scan the <image> file (e.g. a full flash dump\n"
+		"                  or an MTD partition) for EEPROM data of any supported type\n"
+		"                  and save each found EEPROM to <prefix>-<offset>-<eepmap>.bin\n"
+		"                  file. The default <prefix> is 'eep'. This action does not\n"
+		"                  require any connector.\n"
+		"  archive <arch> [<golden>...]  Save fetched raw EEPROM content to the <arch>\n"
+		"                  file as a difference against the most similar reference\n"
+		"                  image. Empty EEPROM and optional <golden> image files are\n"
+		"                  used as references.\n"
+		"  unarchive <arch> <file> [<golden>...]  Restore the raw EEPROM dump from\n"
+		"                  the <arch> archive to the <file>. If the archive refers\n"
+		"                  to a golden image, then it should be specified as well.\n"
+		"                  This action does not require any connector.\n"
+		"  restore <file>  Write the EEPROM content from the <file> (raw dump or\n"
+		"                  container) to the device. Only the changed words are\n"
+		"                  written and each written word is verified by reading it\n"
+		"                  back. An interrupted restoring is resumed on the next run\n"
+		"                  with the same <file> (the progress is kept in the\n"
+		"                  <file>.resume file).\n"
+		"  verify <file> [prio] [all]  Compare the EEPROM content with the reference\n"
+		"                  image from the <file> (raw dump or container) and fail on\n"
+		"                  mismatch. Verification stops on the first mismatch, unless\n"
+		"                  the 'all' option is specified. With the 'prio' option the\n"
+		"                  checksum and header words are checked first (requires a\n"
+		"                  container or the -t option), so a corruption is usually\n"
+		"                  detected with a few EEPROM reads.\n"
+		"  patch create <orig> <new> <patch>  Save the difference between the <orig>\n"
+		"                  and <new> images (raw dumps or containers) to the compact\n"
+		"                  <patch> file: changed words offsets with the original and\n"
+		"                  new values. If possible, the checksum is stored as a delta,\n"
+		"                  so the patch could be applied to devices with different\n"
+		"                  calibration data. This action does not require any\n"
+		"                  connector.\n"
+		"  patch apply <patch> [strict]  Check that the EEPROM contains the original\n"
+		"                  values of the patched words and then write the new values\n"
+		"                  and update the checksum. Only the patched words and the\n"
+		"                  checksum are read and written. With the 'strict' option,\n"
+		"                  the EEPROM checksum should match the original image one.\n"
+		"                  For dump files the -t option is recommended to check that\n"
+		"                  the patch matches the EEPROM map type.\n"
+		"  watch [period=<sec>] [budget=<words>] [time=<sec>] [log=<file>]  Keep\n"
+		"                  the fetched EEPROM content as a baseline and each <sec>\n"
+		"                  seconds (60 by default) re-read the checksum and header\n"
+		"                  words and a rotating sample of <words> words (16 by\n"
+		"                  default). On a sample mismatch the whole EEPROM is re-read\n"
+		"                  and the changed words are reported. Results are written\n"
+		"                  to the <file> log (appended) or to stdout.\n"
+		"  probe [csum]    Print the chip, EEPROM map, MAC address and regdomain in\n"
+		"                  a single line by reading only a few EEPROM words instead\n"
+		"                  of the whole EEPROM fetching and parsing. With the 'csum'\n"
+		"                  option the checksummed area is read to validate it too.\n"
+		"  metrics <file> [cache=<image>] [maxage=<sec>]  Write the chip, EEPROM map,\n"
+		"                  EEPROM check status, GPIO inputs and EEPROM reading\n"
+		"                  statistics to the <file> in the Prometheus text format, the\n"
+		"                  file is updated atomically. With the 'cache' option the\n"
+		"                  EEPROM image is saved to the <image> file and is reused by\n"
+		"                  the next runs while the EEPROM checksum and header words\n"
+		"                  are unchanged and the image is younger than <sec> seconds\n"
+		"                  (a day by default).\n"
+		"  serve <socket> [rw] [mode=<mode>]  Fetch the EEPROM data once and answer\n"
+		"                  requests on the <socket> Unix socket until terminated. A\n"
+		"                  request is any action (e.g. 'dump base') or 'raw <off>\n"
+		"                  [<count>]' to get EEPROM words, 'get <field>' to get chip,\n"
+		"                  srev, map, mac, len or check field and 'refresh' to fetch\n"
+		"                  the EEPROM data again. EEPROM modifying actions (e.g.\n"
+		"                  'update') are allowed only with the 'rw' option. Actions,\n"
+		"                  which access files, are not served. The socket access\n"
+		"                  mode is <mode> (0600 by default).\n"
+		"  query <socket> <request>...  Send the request to the serving daemon and\n"
+		"                  print the response.\n"
+#if defined(CONFIG_BENCH)
+		"  bench [iter=<n>] [warmup=<n>] [lat=<ns>] <image>...  Measure the EEPROM\n"
+		"                  parsing (fill, check and dump) throughput per EEPROM map\n"
+		"                  over the images corpus and then the HW access path against\n"
+		"                  a simulated chip with <ns> register access latency. Map\n"
+		"                  type is taken from the -t option or the file name prefix\n"
+		"                  (e.g. 9300-ubnt.bin). Reports images/s, time percentiles\n"
+		"                  and CPU cycles/instructions when HW counters are available.\n"
+#endif
+		"  provision <pool> [<first>-<last>] <target>...  Assign sequential MAC\n"
+		"                  addresses from the <pool> file to each <target>. Target\n"
+		"                  is specified as a connector option letter and argument\n"
+		"                  separated by a colon (e.g. P:1:0 or F:eep.bin). The pool\n"
+		"                  is initialized by the <first>-<last> addresses range.\n"
+		"                  Issued addresses are recorded to the pool file, which is\n"
+		"                  locked during allocation, so the pool could be shared by\n"
+		"                  several utility instances.\n"
+		"  store <dir>     Save fetched EEPROM content to the content-addressed store\n"
+		"                  in the <dir> directory. Each unique content is saved only\n"
+		"                  once, while the device identity (connector slot, MAC\n"
+		"                  address and chip revision) is logged to the store index.\n"
+		"  storelist <dir> [<dev>]  List the store index records. Optional <dev> filter\n"
+		"                  could be a MAC address, a connector slot or a content hash\n"
+		"                  prefix. This action does not require any connector.\n"
+		"  storeget <dir> <dev> <file>  Save the latest stored EEPROM content of the\n"
+		"                  <dev> device to the <file> raw dump. This action does not\n"
+		"                  require any connector.\n"
 		"\n"
 		"Available connectors (card interactions interface):\n"
 		"  File            Read EEPROM dump from file, activated by -F option with dump\n"
@@ -506,9 +835,19 @@ static void usage(char *name)
 #if defined(CONFIG_CON_PCI)
 		"  PCI             Interact with card via libpciaccess library, activated by -P\n"
 		"                  option with a device slot arg.\n"
+#endif
+#if defined(CONFIG_CON_SYSFS)
+		"  Sysfs           Interact with card via the Linux sysfs PCI resource file,\n"
+		"                  activated by -S option with a device slot or sysfs\n"
+		"                  directory argument.\n"
+#endif
+#if defined(CONFIG_CON_DRIVER)
+		"  Driver          Fetch EEPROM image from the kernel driver (read-only),\n"
+		"                  activated by -D option with a network interface name or\n"
+		"                  a driver file path argument.\n"
 #endif
 		"\n",
-		name, name
+		name, name, name
 	);
 
 	printf("Supported EEPROM map(s) and per-map capabilities:\n");
@@ -517,12 +856,371 @@ static void usage(char *name)
 	printf("\n");
 }
 
+const struct connector *con_find_by_opt(int opt)
+{
+	switch (opt) {
+	case 'F':
+		return &con_file;
+#if defined(CONFIG_CON_MEM)
+	case 'M':
+		return &con_mem;
+#endif
+#if defined(CONFIG_CON_PCI)
+	case 'P':
+		return &con_pci;
+#endif
+#if defined(CONFIG_CON_SYSFS)
+	case 'S':
+		return &con_sysfs;
+#endif
+#if defined(CONFIG_CON_DRIVER)
+	case 'D':
+		return &con_driver;
+#endif
+	}
+
+	return NULL;
+}
+
+/**
+ * Initialize the connector (aem->con) and then initialize HW and fetch the
+ * EEPROM data as it is required by the action flags.
+ */
+/**
+ * Forget the attached device state, so the next attach (e.g. to the next
+ * batch target) starts from scratch.
+ */
+static void aem_reset(struct atheepmgr *aem)
+{
+	free(aem->eep_buf);
+	free(aem->eepmap_priv);
+	free(aem->con_priv);
+	aem->eep_buf = NULL;
+	aem->eepmap_priv = NULL;
+	aem->con_priv = NULL;
+	aem->io_size = 0;
+	aem->eep_len = 0;
+	aem->eep_io_swap = 0;
+	aem->eep = NULL;
+	aem->chip = NULL;
+	aem->regcache_num = 0;
+	aem->rd_num = 0;
+	aem->eep_nreads = 0;
+}
+
+int aem_attach(struct atheepmgr *aem, int flags)
+{
+	bool res;
+	int ret;
+
+	aem->con_priv = malloc(aem->con->priv_data_sz);
+	if (!aem->con_priv) {
+		fprintf(stderr, "Unable to allocate memory for the connector private data\n");
+		return -ENOMEM;
+	}
+
+	TRACE_PROBE1(con_init_enter, aem->con->name);
+	trace_begin(aem, "con_init", aem->con->name);
+	ret = aem->con->init(aem, aem->con_arg);
+	trace_end(aem, "con_init", ret);
+	TRACE_PROBE2(con_init_exit, aem->con->name, ret);
+	if (ret)
+		goto err_free;
+
+	/* NB: connector could set the map type, e.g. from the container */
+	if ((flags & ACT_F_EEPROM) && !aem->eepmap &&
+	    !(aem->con->caps & CON_CAP_HW)) {
+		fprintf(stderr, "EEPROM map type option is mandatory for connectors without direct HW access\n");
+		ret = -EINVAL;
+		goto err_clean;
+	}
+
+	if (aem->con->caps & CON_CAP_HW) {
+		trace_begin(aem, "hw_init", NULL);
+		ret = hw_init(aem);
+		trace_end(aem, "hw_init", ret);
+		if (ret)
+			goto err_clean;
+
+		if (aem->eep_wp_gpio_num != EEP_WP_GPIO_NONE &&
+		    aem->eep_wp_gpio_num >= aem->gpio_num) {
+			fprintf(stderr, "EEPROM unlocking GPIO #%d is out of range 0...%d\n",
+				aem->eep_wp_gpio_num, aem->gpio_num - 1);
+			ret = -EINVAL;
+			goto err_clean;
+		}
+	}
+
+	if (flags & ACT_F_EEPROM) {
+		hw_eeprom_set_ops(aem);
+
+		if (!aem->eepmap) {
+			trace_begin(aem, "eepmap_detect", NULL);
+			ret = eepmap_detect(aem);
+			trace_end(aem, "eepmap_detect", ret);
+			if (ret)
+				goto err_clean;
+		}
+
+		aem->eepmap_priv = calloc(1, aem->eepmap->priv_data_sz);
+		if (!aem->eepmap_priv) {
+			fprintf(stderr, "Unable to allocate memory for the EEPROM parser private data\n");
+			ret = -ENOMEM;
+			goto err_clean;
+		}
+
+		aem->eep_buf = calloc(aem->eepmap->eep_buf_sz,
+				      sizeof(uint16_t));
+		if (!aem->eep_buf) {
+			fprintf(stderr, "Unable to allocate memory for EEPROM buffer\n");
+			ret = -ENOMEM;
+			goto err_clean;
+		}
+
+		res = eepmap_fill(aem);
+		if (aem->rd_rate)
+			hw_read_stat(aem);
+		if (!res) {
+			fprintf(stderr, "Unable to fill EEPROM data\n");
+			ret = -EIO;
+			goto err_clean;
+		}
+
+		aem->eep_check = eepmap_check(aem);
+		if (!aem->eep_check) {
+			fprintf(stderr, "EEPROM check failed\n");
+			ret = -EINVAL;
+			goto err_clean;
+		}
+	} else if (flags & ACT_F_EEPIO) {
+		hw_eeprom_set_ops(aem);
+	}
+
+	return 0;
+
+err_clean:
+	aem->con->clean(aem);
+err_free:
+	aem_reset(aem);
+
+	return ret;
+}
+
+void aem_detach(struct atheepmgr *aem)
+{
+	aem->con->clean(aem);
+	aem_reset(aem);
+}
+
+static const uint16_t *eep_snap;	/* EEPROM content snapshot */
+static size_t eep_snap_len;
+
+static bool eep_snap_read(struct atheepmgr *aem, uint32_t off, uint16_t *data)
+{
+	if (off >= eep_snap_len)
+		return false;
+
+	*data = eep_snap[off];
+
+	return true;
+}
+
+static const struct eep_ops eep_snap_ops = {
+	.read = eep_snap_read,
+};
+
+/**
+ * Parse the EEPROM content from the buffer instead of the EEPROM reading, the
+ * buffer should not overlap with the EEPROM buffer (aem->eep_buf).
+ */
+bool aem_fill_from_buf(struct atheepmgr *aem, const uint16_t *buf, size_t len)
+{
+	const struct eep_ops *eep = aem->eep;
+	unsigned long rd_rate = aem->rd_rate;
+	int io_swap = aem->eep_io_swap;
+	bool res;
+
+	eep_snap = buf;
+	eep_snap_len = len;
+	aem->eep = &eep_snap_ops;
+	aem->eep_io_swap = 0;	/* Buffer data are already normalized */
+	aem->rd_rate = 0;	/* Memory reads do not load the bus */
+
+	res = eepmap_fill(aem);
+
+	aem->eep = eep;
+	aem->eep_io_swap = io_swap;
+	aem->rd_rate = rd_rate;
+	eep_snap = NULL;
+
+	return res;
+}
+
+/**
+ * Refresh the parsed EEPROM data after an action, which modifies EEPROM.
+ * If the action works with the EEPROM buffer (e.g. update), then the
+ * buffer content is parsed again, otherwise the EEPROM is read again.
+ */
+int aem_refill(struct atheepmgr *aem, bool from_buf)
+{
+	uint16_t *snap = NULL;
+	size_t len = 0;
+	bool res;
+
+	if (!aem->eep_buf)
+		return 0;	/* No parsed data */
+
+	/**
+	 * NB: snapshot the whole buffer since the parser could read beyond
+	 * the final EEPROM data length (e.g. while the 9300 map probes
+	 * layouts).
+	 */
+	if (from_buf) {
+		len = aem->eepmap->eep_buf_sz;
+		snap = malloc(len * sizeof(uint16_t));
+		if (!snap) {
+			fprintf(stderr, "Unable to allocate memory for EEPROM snapshot\n");
+			return -ENOMEM;
+		}
+		memcpy(snap, aem->eep_buf, len * sizeof(uint16_t));
+	}
+
+	/* Parsers continue buffer filling from eep_len, so start over */
+	aem->eep_len = 0;
+	memset(aem->eepmap_priv, 0x00, aem->eepmap->priv_data_sz);
+
+	if (from_buf) {
+		res = aem_fill_from_buf(aem, snap, len);
+		free(snap);
+	} else {
+		res = eepmap_fill(aem);
+		if (aem->rd_rate)
+			hw_read_stat(aem);
+	}
+
+	if (!res) {
+		fprintf(stderr, "Unable to fill EEPROM data\n");
+		return -EIO;
+	}
+
+	aem->eep_check = eepmap_check(aem);
+	if (!aem->eep_check) {
+		fprintf(stderr, "EEPROM check failed\n");
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int act_call(struct atheepmgr *aem, const struct action *act,
+		    int argc, char *argv[])
+{
+	int ret;
+
+	trace_begin(aem, act->name, argc > 0 ? argv[0] : NULL);
+	ret = act->func(aem, argc, argv);
+	trace_end(aem, act->name, ret);
+
+	return ret;
+}
+
+/**
+ * Run a single action against the already attached device on behalf of the
+ * serve action. The parsed EEPROM data are refreshed after each modification,
+ * so the following requests see the actual content.
+ */
+int aem_act_run(struct atheepmgr *aem, int argc, char *argv[], bool rw)
+{
+	const struct action *act;
+	int i, ret;
+
+	for (i = 0; i < ARRAY_SIZE(actions); ++i)
+		if (strcasecmp(argv[0], actions[i].name) == 0)
+			break;
+	if (i == ARRAY_SIZE(actions)) {
+		fprintf(stderr, "Unknown action -- %s\n", argv[0]);
+		return -EINVAL;
+	}
+	act = &actions[i];
+
+	if (act->flags & (ACT_F_NOCON | ACT_F_NOSRV)) {
+		fprintf(stderr, "%s action could not be served by the daemon\n",
+			act->name);
+		return -EOPNOTSUPP;
+	}
+	if ((act->flags & ACT_F_HW) && !(aem->con->caps & CON_CAP_HW)) {
+		fprintf(stderr, "%s action require direct HW access, which is not proved by %s connector\n",
+			act->name, aem->con->name);
+		return -EOPNOTSUPP;
+	}
+	if ((act->flags & ACT_F_EEPWR) && !rw) {
+		fprintf(stderr, "%s action modifies EEPROM, which is not allowed by the daemon\n",
+			act->name);
+		return -EPERM;
+	}
+
+	ret = act_call(aem, act, argc - 1, argv + 1);
+	if (ret == 0 && (act->flags & ACT_F_EEPWR))
+		ret = aem_refill(aem, act->flags & ACT_F_EEPROM);
+
+	return ret;
+}
+
+struct act_chain {
+	const struct action *act;
+	int argc;
+	char **argv;
+};
+
+/* Split the arguments to the '--' separated actions list */
+static int act_chain_parse(int argc, char *argv[], struct act_chain **pchain,
+			   int *pnacts)
+{
+	struct act_chain *chain;
+	int i, j, nacts = 0;
+
+	chain = calloc(argc + 1, sizeof(*chain));
+	if (!chain) {
+		fprintf(stderr, "Unable to allocate memory for actions list\n");
+		return -ENOMEM;
+	}
+
+	if (argc == 0) {		/* Default action */
+		chain[nacts++].act = &actions[0];
+		goto exit;
+	}
+
+	for (i = 0; i < argc; ++i) {
+		for (j = 0; j < ARRAY_SIZE(actions); ++j)
+			if (strcasecmp(argv[i], actions[j].name) == 0)
+				break;
+		if (j == ARRAY_SIZE(actions)) {
+			fprintf(stderr, "Unknown action -- %s\n", argv[i]);
+			free(chain);
+			return -EINVAL;
+		}
+		chain[nacts].act = &actions[j];
+		chain[nacts].argv = &argv[i + 1];
+		for (++i; i < argc && strcmp(argv[i], ACT_CHAIN_SEP) != 0; ++i)
+			chain[nacts].argc++;
+		if (i < argc)
+			argv[i] = NULL;	/* Terminate action arguments */
+		nacts++;
+	}
+
+exit:
+	*pchain = chain;
+	*pnacts = nacts;
+
+	return 0;
+}
+
 int main(int argc, char *argv[])
 {
 	struct atheepmgr *aem = &__aem;
-	const struct action *act = NULL;
-	char *con_arg = NULL;
-	int i, opt;
+	struct act_chain *chain = NULL;
+	int i, opt, nacts, flags = 0;
+	char *endp;
 	int ret;
 
 	if (argc == 1) {
@@ -538,21 +1236,36 @@ int main(int argc, char *argv[])
 	while ((opt = getopt(argc, argv, optstr)) != -1) {
 		switch (opt) {
 		case 'F':
-			aem->con = &con_file;
-			con_arg = optarg;
-			break;
 #if defined(CONFIG_CON_MEM)
 		case 'M':
-			aem->con = &con_mem;
-			con_arg = optarg;
-			break;
 #endif
 #if defined(CONFIG_CON_PCI)
 		case 'P':
-			aem->con = &con_pci;
-			con_arg = optarg;
-			break;
 #endif
+#if defined(CONFIG_CON_SYSFS)
+		case 'S':
+#endif
+#if defined(CONFIG_CON_DRIVER)
+		case 'D':
+#endif
+			aem->con = con_find_by_opt(opt);
+			aem->con_arg = optarg;
+			break;
+		case 'c':
+			aem->regcache_on = 1;
+			break;
+		case 'r':
+			aem->rd_rate = strtoul(optarg, &endp, 0);
+			if (*endp != '\0' || !aem->rd_rate) {
+				fprintf(stderr, "Invalid read rate -- %s\n",
+					optarg);
+				goto exit;
+			}
+			break;
+		case 'T':
+			if (trace_open(aem, optarg) != 0)
+				goto exit;
+			break;
 		case 't':
 			aem->eepmap = eepmap_find_by_name(optarg);
 			if (!aem->eepmap) {
@@ -573,109 +1286,61 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	if (!aem->con) {
-		fprintf(stderr, "Connector is not specified\n");
+	ret = act_chain_parse(argc - optind, argv + optind, &chain, &nacts);
+	if (ret)
 		goto exit;
-	}
 
-	if (optind >= argc) {
-		act = &actions[0];
-	} else {
-		for (i = 0; i < ARRAY_SIZE(actions); ++i) {
-			if (strcasecmp(argv[optind], actions[i].name) != 0)
-				continue;
-			act = &actions[i];
-			break;
-		}
-		if (!act) {
-			fprintf(stderr, "Unknown action -- %s\n", argv[optind]);
+	for (i = 0; i < nacts; ++i)
+		flags |= chain[i].act->flags;
+
+	if (flags & ACT_F_NOCON) {
+		if (nacts > 1 && (flags & ~ACT_F_NOCON)) {
+			fprintf(stderr, "Actions, which do not need a connector, could not be chained with others\n");
+			ret = -EINVAL;
 			goto exit;
 		}
-		optind++;
-	}
-
-	if ((act->flags & ACT_F_HW) && !(aem->con->caps & CON_CAP_HW)) {
-		fprintf(stderr, "%s action require direct HW access, which is not proved by %s connector\n",
-			act->name, aem->con->name);
+		for (i = 0, ret = 0; i < nacts && !ret; ++i)
+			ret = act_call(aem, chain[i].act, chain[i].argc,
+				       chain[i].argv);
 		goto exit;
 	}
 
-	if ((act->flags & ACT_F_EEPROM) && !aem->eepmap &&
-	    !(aem->con->caps & CON_CAP_HW)) {
-		fprintf(stderr, "EEPROM map type option is mandatory for connectors without direct HW access\n");
+	ret = -EINVAL;
+	if (!aem->con) {
+		fprintf(stderr, "Connector is not specified\n");
 		goto exit;
 	}
 
-	aem->con_priv = malloc(aem->con->priv_data_sz);
-	if (!aem->con_priv) {
-		fprintf(stderr, "Unable to allocate memory for the connector private data\n");
-		ret = -ENOMEM;
-		goto exit;
+	for (i = 0; i < nacts; ++i) {
+		if ((chain[i].act->flags & ACT_F_HW) &&
+		    !(aem->con->caps & CON_CAP_HW)) {
+			fprintf(stderr, "%s action require direct HW access, which is not proved by %s connector\n",
+				chain[i].act->name, aem->con->name);
+			goto exit;
+		}
 	}
 
-	ret = aem->con->init(aem, con_arg);
+	ret = aem_attach(aem, flags & ~ACT_F_EEPWR);
 	if (ret)
 		goto exit;
 
-	if (aem->con->caps & CON_CAP_HW) {
-		ret = hw_init(aem);
+	for (i = 0; i < nacts; ++i) {
+		ret = act_call(aem, chain[i].act, chain[i].argc,
+			       chain[i].argv);
 		if (ret)
-			goto con_clean;
-
-		if (aem->eep_wp_gpio_num != EEP_WP_GPIO_NONE &&
-		    aem->eep_wp_gpio_num >= aem->gpio_num) {
-			fprintf(stderr, "EEPROM unlocking GPIO #%d is out of range 0...%d\n",
-				aem->eep_wp_gpio_num, aem->gpio_num - 1);
-			goto con_clean;
-		}
-	}
-
-	if (act->flags & ACT_F_EEPROM) {
-		hw_eeprom_set_ops(aem);
-
-		if (!aem->eepmap) {
-			ret = eepmap_detect(aem);
+			break;
+		if (i + 1 < nacts && (chain[i].act->flags & ACT_F_EEPWR)) {
+			ret = aem_refill(aem, chain[i].act->flags & ACT_F_EEPROM);
 			if (ret)
-				goto con_clean;
-		}
-
-		aem->eepmap_priv = malloc(aem->eepmap->priv_data_sz);
-		if (!aem->eepmap_priv) {
-			fprintf(stderr, "Unable to allocate memory for the EEPROM parser private data\n");
-			ret = -ENOMEM;
-			goto con_clean;
-		}
-
-		aem->eep_buf = malloc(aem->eepmap->eep_buf_sz *
-				      sizeof(uint16_t));
-		if (!aem->eep_buf) {
-			fprintf(stderr, "Unable to allocate memory for EEPROM buffer\n");
-			ret = -ENOMEM;
-			goto con_clean;
-		}
-
-		if (!aem->eepmap->fill_eeprom(aem)) {
-			fprintf(stderr, "Unable to fill EEPROM data\n");
-			ret = -EIO;
-			goto con_clean;
-		}
-
-		if (!aem->eepmap->check_eeprom(aem)) {
-			fprintf(stderr, "EEPROM check failed\n");
-			ret = -EINVAL;
-			goto con_clean;
+				break;
 		}
 	}
 
-	ret = act->func(aem, argc - optind, argv + optind);
-
-con_clean:
-	aem->con->clean(aem);
+	aem_detach(aem);
 
 exit:
-	free(aem->eep_buf);
-	free(aem->eepmap_priv);
-	free(aem->con_priv);
+	trace_close(aem);
+	free(chain);
 
 	return ret;
 }
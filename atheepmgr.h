@@ -33,17 +33,20 @@
 #else
 #define le16toh		letoh16
 #define le32toh		letoh32
+#define le64toh		letoh64
 #endif
 #define __BYTE_ORDER _BYTE_ORDER
 #define __BIG_ENDIAN _BIG_ENDIAN
 #define bswap_16	__swap16
 #define bswap_32	__swap32
+#define bswap_64	__swap64
 #elif defined(__FreeBSD__)
 #include <sys/endian.h>
 #define __BYTE_ORDER _BYTE_ORDER
 #define __BIG_ENDIAN _BIG_ENDIAN
 #define bswap_16	bswap16
 #define bswap_32	bswap32
+#define bswap_64	bswap64
 #elif defined(__linux__)
 #include <endian.h>
 #include <byteswap.h>
@@ -54,17 +57,19 @@
 #define htole16(x)	(x)
 #define le32toh(x)	(x)
 #define htole32(x)	(x)
+#define le64toh(x)	(x)
+#define htole64(x)	(x)
 #else
 #define le16toh(x)	bswap_16(x)
 #define htole16(x)	bswap_16(x)
 #define le32toh(x)	bswap_32(x)
 #define htole32(x)	bswap_32(x)
+#define le64toh(x)	bswap_64(x)
+#define htole64(x)	bswap_64(x)
 #endif
 #endif
 #endif
 
-#include "eep_common.h"
-
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
 #define MS(_v, _f)  (((_v) & _f) >> _f##_S)
 #define BIT(_n)				(1 << (_n))
@@ -77,6 +82,8 @@ enum {
 
 typedef int bool;
 
+#include "eep_common.h"
+
 #define AR_SREV_VERSION_5211		0x4
 #define AR_SREV_REVISION_5211		0
 #define AR_SREV_VERSION_5212		0x5
@@ -144,13 +151,30 @@ typedef int bool;
 
 struct atheepmgr;
 
+#define REGCACHE_MAX		8
+
+/* Shadow copy of a register, which is changed only by ourself */
+struct regcache_ent {
+	uint32_t reg;
+	uint32_t val;
+	bool valid;
+};
+
+#define GPIO_NUM_MAX		32
+
+/* All GPIO lines state, which is fetched by a single read of each register */
+struct gpio_state {
+	uint32_t in;				/* Input values bitmap */
+	uint32_t out;				/* Output values bitmap */
+	const char *dir[GPIO_NUM_MAX];		/* Direction (driver mode) */
+	const char *out_mux[GPIO_NUM_MAX];	/* Output mux, NULL if N/A */
+};
+
 struct gpio_ops {
-	int (*input_get)(struct atheepmgr *aem, unsigned gpio);
-	int (*output_get)(struct atheepmgr *aem, unsigned gpio);
+	uint32_t (*input_get)(struct atheepmgr *aem);	/* Lines bitmap */
+	void (*state_get)(struct atheepmgr *aem, struct gpio_state *st);
 	void (*output_set)(struct atheepmgr *aem, unsigned gpio, int val);
 	void (*dir_set_out)(struct atheepmgr *aem, unsigned gpio);
-	const char * (*dir_get_str)(struct atheepmgr *aem, unsigned gpio);
-	const char * (*out_mux_get_str)(struct atheepmgr *aem, unsigned gpio);
 };
 
 struct eep_ops {
@@ -187,6 +211,18 @@ enum eepmap_param_id {
 	__EEP_PARAM_MAX
 };
 
+struct eepmap_area {
+	uint16_t off;			/* Area offset, words */
+	uint16_t len;			/* Area length, words */
+};
+
+/* Inventory data, which is fetched by the map probe routine */
+struct eep_probe {
+	uint8_t mac[6];
+	uint16_t regdmn[2];
+	int csum;			/* 1 - valid, 0 - invalid, -1 - unchecked */
+};
+
 struct eepmap {
 	const char *name;
 	const char *desc;
@@ -194,10 +230,15 @@ struct eepmap {
 	size_t eep_buf_sz;		/* EEP buffer size in 16-bit words */
 	bool (*fill_eeprom)(struct atheepmgr *aem);
 	int (*check_eeprom)(struct atheepmgr *aem);
+	void (*get_macaddr)(struct atheepmgr *aem, uint8_t *mac);
+	bool (*probe)(struct atheepmgr *aem, struct eep_probe *res, bool csum);
 	void (*dump[EEP_SECT_MAX])(struct atheepmgr *aem);
 	bool (*update_eeprom)(struct atheepmgr *aem, int param,
 			      const void *data);
 	int params_mask;		/* Mask of updateable params */
+	const struct eepmap_area *prio_areas;	/* Integrity critical areas */
+	uint16_t csum_loc;		/* XOR checksum word offset, 0 - none */
+	int (*valid_blocks)(struct atheepmgr *aem);	/* Optional, parsed data blocks */
 };
 
 struct atheepmgr {
@@ -206,17 +247,38 @@ struct atheepmgr {
 	int host_is_be;				/* Is host big-endian? */
 
 	const struct connector *con;
+	const char *con_arg;			/* Connector argument */
 	void *con_priv;
+	size_t io_size;				/* Mapped registers space size */
+	int regcache_on;			/* Use registers shadow cache */
+	struct regcache_ent regcache[REGCACHE_MAX];	/* Non-volatile regs */
+	unsigned regcache_num;
 
 	uint32_t macVersion;
 	uint16_t macRev;
+	const struct hw_chip *chip;		/* Chip layout, see hw_init() */
 
 	const struct eepmap *eepmap;
 	void *eepmap_priv;
 
+	unsigned long rd_rate;			/* Max HW reads/s, 0 - no limit */
+	uint64_t rd_start;			/* First paced read time, ns */
+	uint64_t rd_next;			/* Next paced read time, ns */
+	unsigned long rd_num;			/* Number of paced reads */
+
+	unsigned long eep_nreads;		/* Number of EEPROM words reads */
+
+	FILE *trace_fp;				/* Timeline trace, see trace.c */
+	uint64_t trace_start;			/* Trace start time, ns */
+	unsigned trace_tid;			/* Current trace track */
+	uint32_t trace_rd_last;			/* Last traced EEPROM read offset */
+	unsigned trace_rd_num;			/* Words in the traced reads chunk */
+
 	int eep_io_swap;			/* Swap words */
 	uint16_t *eep_buf;			/* Intermediated EEPROM buf */
 	size_t eep_len;			/* Read size of EEPROM data in the buffer */
+	int eep_check;				/* Parsed data check result */
+	bool eep_otp;				/* Data are read from OTP */
 
 	int eep_wp_gpio_num;			/* EEPROM WP GPIO number */
 	int eep_wp_gpio_pol;			/* EEPROM WP unlock polarity */
@@ -227,9 +289,11 @@ struct atheepmgr {
 	unsigned gpio_num;			/* Number of GPIO lines */
 };
 
+extern const struct connector con_driver;
 extern const struct connector con_file;
 extern const struct connector con_mem;
 extern const struct connector con_pci;
+extern const struct connector con_sysfs;
 
 extern const struct eepmap eepmap_5211;
 extern const struct eepmap eepmap_5416;
@@ -237,6 +301,33 @@ extern const struct eepmap eepmap_9285;
 extern const struct eepmap eepmap_9287;
 extern const struct eepmap eepmap_9300;
 
+#define ACT_F_EEPROM	(1 << 0)	/* Action will interact with EEPROM */
+#define ACT_F_HW	(1 << 1)	/* Action require direct HW access */
+#define ACT_F_NOCON	(1 << 2)	/* Action does not need any connector */
+#define ACT_F_EEPIO	(1 << 3)	/* Action will access EEPROM w/o parsing */
+#define ACT_F_EEPWR	(1 << 4)	/* Action modifies EEPROM content */
+#define ACT_F_NOSRV	(1 << 5)	/* Action could not be served by daemon */
+
+int eepmap_detect(struct atheepmgr *aem);
+bool eepmap_fill(struct atheepmgr *aem);
+int eepmap_check(struct atheepmgr *aem);
+const struct connector *con_find_by_opt(int opt);
+int aem_attach(struct atheepmgr *aem, int flags);
+void aem_detach(struct atheepmgr *aem);
+bool aem_fill_from_buf(struct atheepmgr *aem, const uint16_t *buf, size_t len);
+int aem_refill(struct atheepmgr *aem, bool from_buf);
+int aem_act_run(struct atheepmgr *aem, int argc, char *argv[], bool rw);
+const struct eepmap *eepmap_find_by_name(const char *name);
+size_t eepmap_max_buf_sz(void);
+void eep_detect_io_swap(struct atheepmgr *aem, const uint16_t *buf, size_t len);
+
+void hw_regcache_add(struct atheepmgr *aem, uint32_t reg);
+uint32_t hw_reg_read(struct atheepmgr *aem, uint32_t reg);
+void hw_reg_write(struct atheepmgr *aem, uint32_t reg, uint32_t val);
+void hw_reg_rmw(struct atheepmgr *aem, uint32_t reg, uint32_t set,
+		uint32_t clr);
+void hw_read_pace(struct atheepmgr *aem);
+void hw_read_stat(struct atheepmgr *aem);
 bool hw_wait(struct atheepmgr *aem, uint32_t reg, uint32_t mask,
 	     uint32_t val, uint32_t timeout);
 void hw_eeprom_set_ops(struct atheepmgr *aem);
@@ -245,6 +336,27 @@ bool hw_eeprom_write(struct atheepmgr *aem, uint32_t off, uint16_t data);
 void hw_eeprom_lock(struct atheepmgr *aem, int lock);
 int hw_init(struct atheepmgr *aem);
 
+int act_gpio_watch(struct atheepmgr *aem, int argc, char *argv[]);
+int act_reg_dump(struct atheepmgr *aem, int argc, char *argv[]);
+int act_reg_diff(struct atheepmgr *aem, int argc, char *argv[]);
+int act_reg_script(struct atheepmgr *aem, int argc, char *argv[]);
+int act_eep_extract(struct atheepmgr *aem, int argc, char *argv[]);
+int act_eep_archive(struct atheepmgr *aem, int argc, char *argv[]);
+int act_eep_unarchive(struct atheepmgr *aem, int argc, char *argv[]);
+int act_eep_restore(struct atheepmgr *aem, int argc, char *argv[]);
+int act_eep_verify(struct atheepmgr *aem, int argc, char *argv[]);
+int act_eep_patch(struct atheepmgr *aem, int argc, char *argv[]);
+int act_eep_watch(struct atheepmgr *aem, int argc, char *argv[]);
+int act_eep_probe(struct atheepmgr *aem, int argc, char *argv[]);
+int act_eep_metrics(struct atheepmgr *aem, int argc, char *argv[]);
+int act_eep_serve(struct atheepmgr *aem, int argc, char *argv[]);
+int act_eep_query(struct atheepmgr *aem, int argc, char *argv[]);
+int act_bench(struct atheepmgr *aem, int argc, char *argv[]);
+int act_eep_provision(struct atheepmgr *aem, int argc, char *argv[]);
+int act_eep_store(struct atheepmgr *aem, int argc, char *argv[]);
+int act_eep_store_list(struct atheepmgr *aem, int argc, char *argv[]);
+int act_eep_store_get(struct atheepmgr *aem, int argc, char *argv[]);
+
 #define EEP_READ(_off, _data)		\
 		hw_eeprom_read(aem, _off, _data)
 #define EEP_WRITE(_off, _data)		\
@@ -254,10 +366,10 @@ int hw_init(struct atheepmgr *aem);
 #define EEP_UNLOCK()			\
 		hw_eeprom_lock(aem, 0)
 #define REG_READ(_reg)			\
-		aem->con->reg_read(aem, _reg)
+		hw_reg_read(aem, _reg)
 #define REG_WRITE(_reg, _val)		\
-		aem->con->reg_write(aem, _reg, _val)
+		hw_reg_write(aem, _reg, _val)
 #define REG_RMW(_reg, _set, _clr)	\
-		aem->con->reg_rmw(aem, _reg, _set, _clr)
+		hw_reg_rmw(aem, _reg, _set, _clr)
 
 #endif /* ATHEEPMGR_H */
@@ -0,0 +1,498 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#if defined(CONFIG_BENCH)
+
+#include <fcntl.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "atheepmgr.h"
+#include "utils.h"
+#include "hw.h"
+
+/**
+ * Parsers and I/O paths benchmark. Each image of the corpus is parsed (fill,
+ * check and dump of all sections to /dev/null) from memory, and then fetched
+ * via the real HW access code against a simulated chip, which registers are
+ * backed by the same image. Results are aggregated per EEPROM map.
+ */
+
+#define BENCH_ITER_DEF		1000	/* Default measured iterations */
+#define BENCH_WARMUP_DEF	50	/* Default warmup iterations */
+
+struct bench_img {
+	const char *path;
+	const struct eepmap *eepmap;
+	uint16_t *data;
+	size_t len;			/* Words, padded to the map buffer size */
+};
+
+enum bench_cnt {
+	BENCH_CNT_CYCLES,
+	BENCH_CNT_INSNS,
+	__BENCH_CNT_MAX
+};
+
+struct bench_ctx {
+	struct bench_img *imgs;
+	int nimgs;
+	unsigned long iter;
+	unsigned long warmup;
+	unsigned long lat;		/* Simulated register access latency, ns */
+	uint64_t *samples;		/* Per iteration time, ns */
+	int cnt_fd[__BENCH_CNT_MAX];	/* HW counters, -1 if not available */
+	int null_fd;
+};
+
+/* Simulated chip state (there is only one chip at a time) */
+static struct {
+	const struct bench_img *img;
+	uint32_t srev;
+	bool legacy;			/* AR5211 EEPROM interface */
+	uint32_t eep_off;		/* Latched EEPROM word offset */
+	unsigned long lat;
+} bench_sim;
+
+static const struct {
+	const struct eepmap *eepmap;
+	uint32_t mac_version;		/* Simulated chip */
+} bench_sim_chips[] = {
+	{&eepmap_5211, AR_SREV_VERSION_5211},
+	{&eepmap_5416, AR_SREV_VERSION_5416},
+	{&eepmap_9285, AR_SREV_VERSION_9285},
+	{&eepmap_9287, AR_SREV_VERSION_9287},
+	{&eepmap_9300, AR_SREV_VERSION_9300},
+};
+
+static void bench_sim_delay(void)
+{
+	uint64_t until;
+
+	if (!bench_sim.lat)
+		return;
+
+	/* NB: busy waiting, since sleeping is too coarse for a bus access */
+	for (until = time_mono_ns() + bench_sim.lat; time_mono_ns() < until;);
+}
+
+static uint16_t bench_sim_eep_word(void)
+{
+	const struct bench_img *img = bench_sim.img;
+
+	return bench_sim.eep_off < img->len ? img->data[bench_sim.eep_off] :
+					      0xffff;
+}
+
+static uint32_t bench_sim_reg_read(struct atheepmgr *aem, uint32_t reg)
+{
+	bench_sim_delay();
+
+	if (reg == AR_SREV)
+		return bench_sim.srev;
+
+	if (bench_sim.legacy) {
+		if (reg == AR5211_EEPROM_STATUS)
+			return AR5211_EEPROM_STATUS_READ_COMPLETE;
+		if (reg == AR5211_EEPROM_DATA)
+			return bench_sim_eep_word();
+		return 0;
+	}
+
+	if (aem->chip && reg == aem->chip->eep_status_data)
+		return bench_sim_eep_word() << AR_EEPROM_STATUS_DATA_VAL_S;
+	if (reg >= AR5416_EEPROM_OFFSET && reg < AR5416_EEPROM_OFFSET +
+	    (bench_sim.img->len << AR5416_EEPROM_S)) {
+		bench_sim.eep_off = (reg - AR5416_EEPROM_OFFSET) >>
+				    AR5416_EEPROM_S;
+		return 0;
+	}
+
+	return 0;
+}
+
+static void bench_sim_reg_write(struct atheepmgr *aem, uint32_t reg,
+				uint32_t val)
+{
+	bench_sim_delay();
+
+	if (bench_sim.legacy && reg == AR5211_EEPROM_ADDR)
+		bench_sim.eep_off = val;
+}
+
+static void bench_sim_reg_rmw(struct atheepmgr *aem, uint32_t reg,
+			      uint32_t set, uint32_t clr)
+{
+	uint32_t val = bench_sim_reg_read(aem, reg);
+
+	bench_sim_reg_write(aem, reg, (val & ~clr) | set);
+}
+
+static int bench_sim_init(struct atheepmgr *aem, const char *arg_str)
+{
+	return 0;
+}
+
+static void bench_sim_clean(struct atheepmgr *aem)
+{
+}
+
+static const struct connector con_bench_sim = {
+	.name = "Simulated",
+	.priv_data_sz = 0,
+	.caps = CON_CAP_HW,
+	.init = bench_sim_init,
+	.clean = bench_sim_clean,
+	.reg_read = bench_sim_reg_read,
+	.reg_write = bench_sim_reg_write,
+	.reg_rmw = bench_sim_reg_rmw,
+};
+
+static void bench_cnt_open(struct bench_ctx *ctx)
+{
+	int i;
+
+	for (i = 0; i < __BENCH_CNT_MAX; ++i)
+		ctx->cnt_fd[i] = -1;
+
+#ifdef __linux__
+	static const uint64_t configs[__BENCH_CNT_MAX] = {
+		[BENCH_CNT_CYCLES] = PERF_COUNT_HW_CPU_CYCLES,
+		[BENCH_CNT_INSNS] = PERF_COUNT_HW_INSTRUCTIONS,
+	};
+	struct perf_event_attr attr;
+
+	for (i = 0; i < __BENCH_CNT_MAX; ++i) {
+		memset(&attr, 0x00, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = configs[i];
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		ctx->cnt_fd[i] = syscall(__NR_perf_event_open, &attr, 0, -1,
+					 -1, 0);
+	}
+#endif
+}
+
+static void bench_cnt_ctl(struct bench_ctx *ctx, bool start)
+{
+#ifdef __linux__
+	int i;
+
+	for (i = 0; i < __BENCH_CNT_MAX; ++i) {
+		if (ctx->cnt_fd[i] < 0)
+			continue;
+		if (start)
+			ioctl(ctx->cnt_fd[i], PERF_EVENT_IOC_RESET, 0);
+		ioctl(ctx->cnt_fd[i], start ? PERF_EVENT_IOC_ENABLE :
+					      PERF_EVENT_IOC_DISABLE, 0);
+	}
+#endif
+}
+
+static void bench_cnt_close(struct bench_ctx *ctx)
+{
+	int i;
+
+	for (i = 0; i < __BENCH_CNT_MAX; ++i)
+		if (ctx->cnt_fd[i] >= 0)
+			close(ctx->cnt_fd[i]);
+}
+
+static int bench_img_load(struct atheepmgr *aem, struct bench_img *img,
+			  const char *path)
+{
+	const char *name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+	char mapname[0x10];
+	size_t sz;
+	FILE *fp;
+
+	img->path = path;
+	img->eepmap = aem->eepmap;
+	if (!img->eepmap) {	/* Map type is a file name prefix, e.g. 9300-xx.bin */
+		snprintf(mapname, sizeof(mapname), "%.*s",
+			 (int)strcspn(name, "-_."), name);
+		img->eepmap = eepmap_find_by_name(mapname);
+	}
+	if (!img->eepmap) {
+		fprintf(stderr, "%s: unable to determine EEPROM map type, use the -t option or the map name as the file name prefix\n",
+			path);
+		return -EINVAL;
+	}
+
+	fp = fopen(path, "rb");
+	if (!fp) {
+		fprintf(stderr, "Unable to open %s: %s\n", path, strerror(errno));
+		return -errno;
+	}
+	fseek(fp, 0, SEEK_END);
+	sz = ftell(fp) / sizeof(uint16_t);
+	rewind(fp);
+
+	/* NB: pad the image as an empty EEPROM area, as the file connector do */
+	img->len = sz > img->eepmap->eep_buf_sz ? sz : img->eepmap->eep_buf_sz;
+	img->data = malloc(img->len * sizeof(uint16_t));
+	if (!img->data) {
+		fprintf(stderr, "Unable to allocate memory for %s\n", path);
+		fclose(fp);
+		return -ENOMEM;
+	}
+	memset(img->data, 0xff, img->len * sizeof(uint16_t));
+	if (fread(img->data, sizeof(uint16_t), sz, fp) != sz) {
+		fprintf(stderr, "Unable to read %s\n", path);
+		fclose(fp);
+		free(img->data);
+		img->data = NULL;
+		return -EIO;
+	}
+	fclose(fp);
+
+	return 0;
+}
+
+/* Parse the image from memory: fill, check and dump all sections */
+static bool bench_parse(struct atheepmgr *aem, const struct bench_img *img)
+{
+	int i;
+
+	memset(aem->eepmap_priv, 0x00, aem->eepmap->priv_data_sz);
+	aem->eep_len = 0;
+	aem->eep_io_swap = 0;
+
+	if (!aem_fill_from_buf(aem, img->data, img->len) || !eepmap_check(aem))
+		return false;
+
+	for (i = 0; i < EEP_SECT_MAX; ++i)
+		if (aem->eepmap->dump[i])
+			aem->eepmap->dump[i](aem);
+
+	return true;
+}
+
+/* Fetch the image via the HW access code from the simulated chip */
+static bool bench_fetch(struct atheepmgr *aem, const struct bench_img *img)
+{
+	bool res;
+
+	bench_sim.img = img;
+	aem->eepmap = NULL;	/* Detect by the simulated SREV */
+	res = aem_attach(aem, ACT_F_EEPROM) == 0;
+	if (res) {
+		res = aem->eepmap == img->eepmap;
+		aem_detach(aem);
+	}
+
+	return res;
+}
+
+static int bench_u64_cmp(const void *a, const void *b)
+{
+	const uint64_t *x = a, *y = b;
+
+	return *x < *y ? -1 : *x > *y;
+}
+
+static int bench_run(struct atheepmgr *aem, struct bench_ctx *ctx,
+		     const struct eepmap *eepmap, bool sim)
+{
+	uint64_t cnt[__BENCH_CNT_MAX] = {0}, ts, total = 0;
+	const struct bench_img *img;
+	unsigned long i, n, nimgs = 0;
+	int sout, serr, j, ret = 0;
+
+	for (j = 0; j < ctx->nimgs; ++j)
+		if (ctx->imgs[j].eepmap == eepmap)
+			nimgs++;
+	if (!nimgs)
+		return 0;
+
+	if (sim) {
+		for (j = 0; j < ARRAY_SIZE(bench_sim_chips); ++j)
+			if (bench_sim_chips[j].eepmap == eepmap)
+				break;
+		if (j == ARRAY_SIZE(bench_sim_chips))
+			return 0;
+		n = bench_sim_chips[j].mac_version;
+		bench_sim.srev = n > (AR_SREV_VERSION >> AR_SREV_VERSION_S) ?
+				 AR_SREV_ID | n << AR_SREV_TYPE2_S :
+				 n << AR_SREV_VERSION_S;
+		bench_sim.legacy = n < AR_SREV_VERSION_5418;
+	} else {
+		aem->eepmap = eepmap;
+		aem->eepmap_priv = calloc(1, eepmap->priv_data_sz);
+		aem->eep_buf = malloc(eepmap->eep_buf_sz * sizeof(uint16_t));
+		if (!aem->eepmap_priv || !aem->eep_buf) {
+			fprintf(stderr, "Unable to allocate memory for EEPROM data\n");
+			ret = -ENOMEM;
+			goto exit;
+		}
+	}
+
+	/* Dumps (and parsers warnings) go to nowhere */
+	fflush(stdout);
+	fflush(stderr);
+	sout = dup(STDOUT_FILENO);
+	serr = dup(STDERR_FILENO);
+	dup2(ctx->null_fd, STDOUT_FILENO);
+	dup2(ctx->null_fd, STDERR_FILENO);
+
+	for (i = 0, j = -1; i < ctx->warmup + ctx->iter; ++i) {
+		do {		/* Cycle through the map images */
+			j = (j + 1) % ctx->nimgs;
+			img = &ctx->imgs[j];
+		} while (img->eepmap != eepmap);
+
+		if (i == ctx->warmup)
+			bench_cnt_ctl(ctx, true);
+		ts = time_mono_ns();
+		if (!(sim ? bench_fetch(aem, img) : bench_parse(aem, img))) {
+			ret = -EIO;
+			break;
+		}
+		if (i >= ctx->warmup)
+			ctx->samples[i - ctx->warmup] = time_mono_ns() - ts;
+	}
+	bench_cnt_ctl(ctx, false);
+
+	fflush(stdout);
+	fflush(stderr);
+	dup2(sout, STDOUT_FILENO);
+	dup2(serr, STDERR_FILENO);
+	close(sout);
+	close(serr);
+
+	if (ret) {
+		fprintf(stderr, "%s: %s failed, aborting\n", img->path,
+			sim ? "simulated chip fetching" : "parsing");
+		goto exit;
+	}
+
+	for (j = 0; j < __BENCH_CNT_MAX; ++j)
+		if (ctx->cnt_fd[j] >= 0 &&
+		    read(ctx->cnt_fd[j], &cnt[j], sizeof(cnt[j])) != sizeof(cnt[j]))
+			cnt[j] = 0;
+
+	for (i = 0; i < ctx->iter; ++i)
+		total += ctx->samples[i];
+	qsort(ctx->samples, ctx->iter, sizeof(ctx->samples[0]), bench_u64_cmp);
+
+	printf("%-5s %-5s %3lu %10.1f %9.2f %9.2f %9.2f %9.2f", eepmap->name,
+	       sim ? "sim" : "parse", nimgs, ctx->iter * 1e9 / total,
+	       ctx->samples[0] / 1e3, ctx->samples[ctx->iter / 2] / 1e3,
+	       ctx->samples[ctx->iter * 90 / 100] / 1e3,
+	       ctx->samples[ctx->iter * 99 / 100] / 1e3);
+	for (j = 0; j < __BENCH_CNT_MAX; ++j) {
+		if (cnt[j])
+			printf(" %11.0f", (double)cnt[j] / ctx->iter);
+		else
+			printf(" %11s", "n/a");
+	}
+	printf("\n");
+
+exit:
+	if (!sim) {
+		free(aem->eepmap_priv);
+		free(aem->eep_buf);
+		aem->eepmap_priv = NULL;
+		aem->eep_buf = NULL;
+		aem->eep_len = 0;
+	}
+
+	return ret;
+}
+
+int act_bench(struct atheepmgr *aem, int argc, char *argv[])
+{
+	static const struct eepmap * const eepmaps[] = {
+		&eepmap_5211, &eepmap_5416, &eepmap_9285, &eepmap_9287,
+		&eepmap_9300,
+	};
+	const struct eepmap *eepmap = aem->eepmap;
+	struct bench_ctx __ctx = {0}, *ctx = &__ctx;
+	int i, sim, ret = 0;
+
+	ctx->iter = BENCH_ITER_DEF;
+	ctx->warmup = BENCH_WARMUP_DEF;
+	for (; argc > 0 && strchr(argv[0], '='); argc--, argv++) {
+		if (!parse_opt_ulong(argv[0], "iter", &ctx->iter) &&
+		    !parse_opt_ulong(argv[0], "warmup", &ctx->warmup) &&
+		    !parse_opt_ulong(argv[0], "lat", &ctx->lat)) {
+			fprintf(stderr, "Invalid benchmark option -- %s\n",
+				argv[0]);
+			return -EINVAL;
+		}
+	}
+	if (argc < 1 || !ctx->iter) {
+		fprintf(stderr, "Corpus images and non-zero iterations number should be specified, aborting\n");
+		return -EINVAL;
+	}
+
+	ctx->imgs = calloc(argc, sizeof(ctx->imgs[0]));
+	ctx->samples = malloc(ctx->iter * sizeof(ctx->samples[0]));
+	if (!ctx->imgs || !ctx->samples) {
+		fprintf(stderr, "Unable to allocate memory for the benchmark\n");
+		ret = -ENOMEM;
+		goto exit;
+	}
+	for (ctx->nimgs = 0; ctx->nimgs < argc; ctx->nimgs++) {
+		ret = bench_img_load(aem, &ctx->imgs[ctx->nimgs],
+				     argv[ctx->nimgs]);
+		if (ret)
+			goto exit;
+	}
+
+	ctx->null_fd = open("/dev/null", O_WRONLY);
+	if (ctx->null_fd < 0) {
+		fprintf(stderr, "Unable to open /dev/null: %s\n",
+			strerror(errno));
+		ret = -errno;
+		goto exit;
+	}
+
+	bench_cnt_open(ctx);
+	bench_sim.lat = ctx->lat;
+	aem->con = &con_bench_sim;
+
+	printf("%d image(s), %lu iterations after %lu warmup ones, simulated register access latency %lu ns%s\n",
+	       ctx->nimgs, ctx->iter, ctx->warmup, ctx->lat,
+	       ctx->cnt_fd[BENCH_CNT_CYCLES] < 0 ? ", HW counters are not available" : "");
+	printf("%-5s %-5s %3s %10s %9s %9s %9s %9s %11s %11s\n", "Map", "Path",
+	       "Img", "Img/s", "Min, us", "p50, us", "p90, us", "p99, us",
+	       "Cycles/img", "Insns/img");
+	for (sim = 0; sim < 2 && !ret; ++sim)
+		for (i = 0; i < ARRAY_SIZE(eepmaps) && !ret; ++i)
+			ret = bench_run(aem, ctx, eepmaps[i], sim);
+
+	aem->con = NULL;
+	aem->eepmap = eepmap;
+	bench_cnt_close(ctx);
+	close(ctx->null_fd);
+
+exit:
+	for (i = 0; i < ctx->nimgs; ++i)
+		free(ctx->imgs[i].data);
+	free(ctx->imgs);
+	free(ctx->samples);
+
+	return ret;
+}
+
+#endif	/* CONFIG_BENCH */
@@ -1,2 +1,3 @@
 set -ex
-STAGING_DIR= LC_ALL=C ~/Downloads/openwrt-sdk-18.06.1-ar71xx-generic_gcc-7.3.0_musl.Linux-x86_64/staging_dir/toolchain-mips_24kc_gcc-7.3.0_musl/bin/mips-openwrt-linux-gcc   -Wl,-rpath /home/san/Downloads/openwrt-sdk-18.06.1-ar71xx-generic_gcc-7.3.0_musl.Linux-x86_64/staging_dir/toolchain-mips_24kc_gcc-7.3.0_musl/lib  -L /home/san/Downloads/openwrt-sdk-18.06.1-ar71xx-generic_gcc-7.3.0_musl.Linux-x86_64/staging_dir/toolchain-mips_24kc_gcc-7.3.0_musl/lib/ -lgcc -DCONFIG_CON_MEM -DCONFIG_I_KNOW_WHAT_I_AM_DOING atheepmgr.c  con_file.c  con_mem.c  eep_5211.c  eep_5416.c  eep_9285.c  eep_9287.c  eep_9300.c  eep_common.c  hw.c  utils.c -o atheepmgr
+STAGING_DIR= LC_ALL=C ~/Downloads/openwrt-sdk-18.06.1-ar71xx-generic_gcc-7.3.0_musl.Linux-x86_64/staging_dir/toolchain-mips_24kc_gcc-7.3.0_musl/bin/mips-openwrt-linux-gcc   -Wl,-rpath /home/san/Downloads/openwrt-sdk-18.06.1-ar71xx-generic_gcc-7.3.0_musl.Linux-x86_64/staging_dir/toolchain-mips_24kc_gcc-7.3.0_musl/lib  -L /home/san/Downloads/openwrt-sdk-18.06.1-ar71xx-generic_gcc-7.3.0_musl.Linux-x86_64/staging_dir/toolchain-mips_24kc_gcc-7.3.0_musl/lib/ -lgcc -DCONFIG_CON_MEM -DCONFIG_CON_SYSFS -DCONFIG_CON_DRIVER -DCONFIG_I_KNOW_WHAT_I_AM_DOING archive.c  atheepmgr.c  con_driver.c  con_file.c  con_mem.c  con_sysfs.c  container.c  eep_5211.c  eep_5416.c  eep_9285.c  eep_9287.c  eep_9300.c  eep_common.c  eepwatch.c  extract.c  gpiowatch.c  hw.c  metrics.c  patch.c  pci_devs.c  probe.c  provision.c  regdump.c  regscript.c  restore.c  serve.c  store.c  trace.c  utils.c  verify.c -o atheepmgr
+STAGING_DIR= LC_ALL=C ~/Downloads/openwrt-sdk-18.06.1-ar71xx-generic_gcc-7.3.0_musl.Linux-x86_64/staging_dir/toolchain-mips_24kc_gcc-7.3.0_musl/bin/mips-openwrt-linux-gcc   -Wl,-rpath /home/san/Downloads/openwrt-sdk-18.06.1-ar71xx-generic_gcc-7.3.0_musl.Linux-x86_64/staging_dir/toolchain-mips_24kc_gcc-7.3.0_musl/lib  -L /home/san/Downloads/openwrt-sdk-18.06.1-ar71xx-generic_gcc-7.3.0_musl.Linux-x86_64/staging_dir/toolchain-mips_24kc_gcc-7.3.0_musl/lib/ -lgcc -DCONFIG_CON_MEM -DCONFIG_CON_SYSFS -DCONFIG_CON_DRIVER -DCONFIG_I_KNOW_WHAT_I_AM_DOING -DCONFIG_BENCH archive.c  atheepmgr.c  bench.c  con_driver.c  con_file.c  con_mem.c  con_sysfs.c  container.c  eep_5211.c  eep_5416.c  eep_9285.c  eep_9287.c  eep_9300.c  eep_common.c  eepwatch.c  extract.c  gpiowatch.c  hw.c  metrics.c  patch.c  pci_devs.c  probe.c  provision.c  regdump.c  regscript.c  restore.c  serve.c  store.c  trace.c  utils.c  verify.c -o atheepmgr-bench
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <linux/ethtool.h>
+#include <linux/sockios.h>
+
+#include "atheepmgr.h"
+
+#define DRV_DATA_MAX		0x10000	/* Max EEPROM image size, bytes */
+
+/**
+ * Read-only connector, which fetches the EEPROM image from the kernel
+ * driver, so the card could be inspected while it is in service. The image
+ * is fetched once via the ethtool EEPROM dump interface of the specified
+ * network interface or read from a file (e.g. a driver debugfs file or a
+ * captured image), if the argument is a path.
+ */
+struct drv_priv {
+	uint8_t *data;
+	uint32_t data_len;	/* Image length, bytes */
+};
+
+static uint32_t drv_reg_read(struct atheepmgr *aem, uint32_t reg)
+{
+	fprintf(stderr, "condrv: direct reg access is not supported\n");
+
+	return 0;
+}
+
+static void drv_reg_write(struct atheepmgr *aem, uint32_t reg, uint32_t val)
+{
+	fprintf(stderr, "condrv: direct reg write is not supported\n");
+}
+
+static void drv_reg_rmw(struct atheepmgr *aem, uint32_t reg, uint32_t set,
+			uint32_t clr)
+{
+	fprintf(stderr, "condrv: direct reg RMW is not supported\n");
+}
+
+static bool drv_eeprom_read(struct atheepmgr *aem, uint32_t off, uint16_t *data)
+{
+	struct drv_priv *dpd = aem->con_priv;
+	uint32_t pos = off * 2;
+
+	if (pos + sizeof(uint16_t) > dpd->data_len) {	/* Emulate empty area */
+		*data = 0xffff;
+		return true;
+	}
+
+	memcpy(data, dpd->data + pos, sizeof(uint16_t));
+
+	return true;
+}
+
+static bool drv_eeprom_write(struct atheepmgr *aem, uint32_t off, uint16_t data)
+{
+	fprintf(stderr, "condrv: EEPROM modification is not supported\n");
+
+	return false;
+}
+
+static int drv_fetch_file(struct drv_priv *dpd, const char *fname)
+{
+	size_t len = 0, res;
+	FILE *fp;
+
+	/* NB: debugfs files size is unknown, so just read up to the limit */
+	dpd->data = malloc(DRV_DATA_MAX);
+	if (!dpd->data) {
+		fprintf(stderr, "condrv: unable to allocate memory for EEPROM data\n");
+		return -ENOMEM;
+	}
+
+	fp = fopen(fname, "rb");
+	if (!fp) {
+		fprintf(stderr, "condrv: unable to open %s: %s\n", fname,
+			strerror(errno));
+		return -errno;
+	}
+
+	while (len < DRV_DATA_MAX &&
+	       (res = fread(dpd->data + len, 1, DRV_DATA_MAX - len, fp)) > 0)
+		len += res;
+
+	if (ferror(fp)) {
+		fprintf(stderr, "condrv: unable to read %s\n", fname);
+		fclose(fp);
+		return -EIO;
+	}
+	fclose(fp);
+
+	dpd->data_len = len;
+
+	return 0;
+}
+
+static int drv_fetch_ethtool(struct drv_priv *dpd, const char *ifname)
+{
+	struct ethtool_drvinfo drvinfo = {.cmd = ETHTOOL_GDRVINFO};
+	struct ethtool_eeprom *ee;
+	struct ifreq ifr;
+	int sock, ret;
+
+	if (strlen(ifname) >= sizeof(ifr.ifr_name)) {
+		fprintf(stderr, "condrv: invalid interface name -- %s\n",
+			ifname);
+		return -EINVAL;
+	}
+
+	sock = socket(AF_INET, SOCK_DGRAM, 0);
+	if (sock < 0) {
+		fprintf(stderr, "condrv: unable to open socket: %s\n",
+			strerror(errno));
+		return -errno;
+	}
+
+	memset(&ifr, 0x00, sizeof(ifr));
+	strcpy(ifr.ifr_name, ifname);
+	ifr.ifr_data = (void *)&drvinfo;
+	if (ioctl(sock, SIOCETHTOOL, &ifr) != 0) {
+		fprintf(stderr, "condrv: unable to get %s driver info: %s\n",
+			ifname, strerror(errno));
+		ret = -errno;
+		goto exit;
+	}
+	if (!drvinfo.eedump_len) {
+		fprintf(stderr, "condrv: %s driver (%s) does not export EEPROM\n",
+			ifname, drvinfo.driver);
+		ret = -EOPNOTSUPP;
+		goto exit;
+	}
+	if (drvinfo.eedump_len > DRV_DATA_MAX)
+		drvinfo.eedump_len = DRV_DATA_MAX;
+
+	ee = malloc(sizeof(*ee) + drvinfo.eedump_len);
+	if (!ee) {
+		fprintf(stderr, "condrv: unable to allocate memory for EEPROM data\n");
+		ret = -ENOMEM;
+		goto exit;
+	}
+	ee->cmd = ETHTOOL_GEEPROM;
+	ee->offset = 0;
+	ee->len = drvinfo.eedump_len;
+	ifr.ifr_data = (void *)ee;
+	if (ioctl(sock, SIOCETHTOOL, &ifr) != 0) {
+		fprintf(stderr, "condrv: unable to dump %s EEPROM: %s\n",
+			ifname, strerror(errno));
+		ret = -errno;
+		free(ee);
+		goto exit;
+	}
+
+	/* Reuse the request buffer for the data to avoid an extra copy */
+	dpd->data_len = ee->len;
+	memmove(ee, ee->data, ee->len);
+	dpd->data = (uint8_t *)ee;
+	ret = 0;
+
+exit:
+	close(sock);
+
+	return ret;
+}
+
+static int drv_init(struct atheepmgr *aem, const char *arg_str)
+{
+	struct drv_priv *dpd = aem->con_priv;
+	int ret;
+
+	dpd->data = NULL;
+	if (strchr(arg_str, '/'))
+		ret = drv_fetch_file(dpd, arg_str);
+	else
+		ret = drv_fetch_ethtool(dpd, arg_str);
+	if (ret) {
+		free(dpd->data);
+		return ret;
+	}
+
+	if (dpd->data_len < sizeof(uint16_t)) {
+		fprintf(stderr, "condrv: EEPROM image is empty\n");
+		free(dpd->data);
+		return -EINVAL;
+	}
+
+	if (aem->verbose)
+		printf("Fetched %u bytes of EEPROM image from %s\n",
+		       dpd->data_len, arg_str);
+
+	return 0;
+}
+
+static void drv_clean(struct atheepmgr *aem)
+{
+	struct drv_priv *dpd = aem->con_priv;
+
+	free(dpd->data);
+}
+
+static const struct eep_ops eep_drv = {
+	.read = drv_eeprom_read,
+	.write = drv_eeprom_write,
+};
+
+const struct connector con_driver = {
+	.name = "Driver",
+	.priv_data_sz = sizeof(struct drv_priv),
+	.init = drv_init,
+	.clean = drv_clean,
+	.reg_read = drv_reg_read,
+	.reg_write = drv_reg_write,
+	.reg_rmw = drv_reg_rmw,
+	.eep = &eep_drv,
+};
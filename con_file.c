@@ -14,12 +14,35 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#ifdef __linux__
+#include <sys/sysmacros.h>
+#endif
+
 #include "atheepmgr.h"
+#include "container.h"
 
 struct file_priv {
 	FILE *fp;
 	uint32_t data_len;	/* File data length */
 	uint32_t ic_sz;		/* IC size for addr wrap emulation */
+
+	/* Window mode (file or block device region) */
+	int fd;			/* Window mode file descriptor or -1 */
+	bool rdonly;		/* File is opened for reading only */
+	bool mtd;		/* File is a MTD character device */
+	off_t win_off;		/* Window offset inside the file */
+	uint32_t win_sz;	/* Window size, bytes */
+	void *map;		/* Mapping, which covers the window, or NULL */
+	size_t map_len;		/* Mapping length */
+	uint8_t *win;		/* Window start inside the mapping */
+
+	/* Container mode */
+	uint16_t *cont_buf;	/* Decoded container data */
+	int cont_swap;		/* Data should be byteswapped on reading */
 };
 
 /* See: https://graphics.stanford.edu/~seander/bithacks.html#RoundUpPowerOf2 */
@@ -53,11 +76,61 @@ static void file_reg_rmw(struct atheepmgr *aem, uint32_t reg, uint32_t set,
 	fprintf(stderr, "confile: direct reg RMW is not supported\n");
 }
 
+static bool file_win_read(struct file_priv *fpd, uint32_t off, uint16_t *data)
+{
+	uint32_t pos = off * 2;
+
+	if (pos >= fpd->win_sz) {	/* Emulate empty area */
+		*data = 0xffff;
+		return true;
+	}
+
+	if (fpd->win) {
+		memcpy(data, fpd->win + pos, sizeof(uint16_t));
+		return true;
+	}
+
+	return pread(fpd->fd, data, sizeof(uint16_t), fpd->win_off + pos) ==
+	       sizeof(uint16_t);
+}
+
+static bool file_win_write(struct file_priv *fpd, uint32_t off, uint16_t data)
+{
+	uint32_t pos = off * 2;
+
+	if (pos >= fpd->win_sz) {
+		fprintf(stderr, "confile: write to 0x%04x is out of the 0x%04x bytes window\n",
+			pos, fpd->win_sz);
+		return false;
+	}
+
+	if (fpd->mtd) {
+		fprintf(stderr, "confile: MTD device writing is not supported, since the flash should be erased first\n");
+		return false;
+	}
+
+	if (fpd->rdonly) {
+		fprintf(stderr, "confile: file is opened for reading only\n");
+		return false;
+	}
+
+	if (fpd->win) {
+		memcpy(fpd->win + pos, &data, sizeof(uint16_t));
+		return true;
+	}
+
+	return pwrite(fpd->fd, &data, sizeof(uint16_t), fpd->win_off + pos) ==
+	       sizeof(uint16_t);
+}
+
 static bool file_eeprom_read(struct atheepmgr *aem, uint32_t off, uint16_t *data)
 {
 	struct file_priv *fpd = aem->con_priv;
 	uint32_t pos = off * 2;
 
+	if (fpd->fd >= 0)
+		return file_win_read(fpd, off, data);
+
 	pos = pos % fpd->ic_sz;		/* Emulate address wrap */
 
 	if (pos >= fpd->data_len) {	/* Emulate empty area */
@@ -65,6 +138,13 @@ static bool file_eeprom_read(struct atheepmgr *aem, uint32_t off, uint16_t *data
 		return true;
 	}
 
+	if (fpd->cont_buf) {
+		*data = fpd->cont_buf[pos / 2];
+		if (fpd->cont_swap)	/* Restore the original bytes order */
+			*data = bswap_16(*data);
+		return true;
+	}
+
 	if (fseek(fpd->fp, pos, SEEK_SET) != 0)
 		return false;
 
@@ -80,6 +160,14 @@ static bool file_eeprom_write(struct atheepmgr *aem, uint32_t off, uint16_t data
 	static const uint16_t fill = 0xffff;
 	uint32_t pos = off * 2, addr;
 
+	if (fpd->fd >= 0)
+		return file_win_write(fpd, off, data);
+
+	if (fpd->cont_buf) {
+		fprintf(stderr, "confile: container file modification is not supported\n");
+		return false;
+	}
+
 	pos = pos % fpd->ic_sz;		/* Emulate address wrap */
 
 	if (pos >= fpd->data_len) {
@@ -102,12 +190,185 @@ static bool file_eeprom_write(struct atheepmgr *aem, uint32_t off, uint16_t data
 	return true;
 }
 
+/**
+ * Parse the window specification suffix in form <file>:<offset>[:<size>].
+ * Returns 0 if the suffix is found, in this case the file name is truncated.
+ */
+static int file_parse_win(char *fname, unsigned long *off, unsigned long *sz)
+{
+	unsigned long val[2];
+	char *p, *endp;
+	int n = 0;
+
+	while (n < 2 && (p = strrchr(fname, ':')) != NULL) {
+		errno = 0;
+		val[n] = strtoul(p + 1, &endp, 0);
+		if (errno || p[1] == '\0' || *endp != '\0')
+			break;
+		*p = '\0';
+		n++;
+	}
+
+	if (n == 0)
+		return -ENOENT;
+
+	if (n == 1) {
+		*off = val[0];
+		*sz = 0;
+	} else {
+		*off = val[1];
+		*sz = val[0];
+	}
+
+	return 0;
+}
+
+static bool file_is_mtd(const char *fname)
+{
+#ifdef __linux__
+	struct stat st;
+
+	return stat(fname, &st) == 0 && S_ISCHR(st.st_mode) &&
+	       major(st.st_rdev) == 90;	/* MTD_CHAR_MAJOR */
+#else
+	return false;
+#endif
+}
+
+static int file_win_init(struct atheepmgr *aem, const char *fname,
+			 unsigned long off, unsigned long sz)
+{
+	struct file_priv *fpd = aem->con_priv;
+	long pgsz = sysconf(_SC_PAGESIZE);
+	off_t len, map_off;
+	int err;
+
+	/**
+	 * Flash should be erased before it could be written and an erase
+	 * block is much bigger than the EEPROM word, so plain writing of a MTD
+	 * device corrupts data. Open such devices for reading only.
+	 */
+	fpd->mtd = file_is_mtd(fname);
+	fpd->rdonly = fpd->mtd;
+	fpd->fd = fpd->mtd ? -1 : open(fname, O_RDWR);
+	if (fpd->fd < 0 && (fpd->mtd || errno == EACCES || errno == EROFS)) {
+		fpd->rdonly = true;
+		fpd->fd = open(fname, O_RDONLY);
+	}
+	if (fpd->fd < 0) {
+		fprintf(stderr, "confile: can not open file '%s': %s\n",
+			fname, strerror(errno));
+		return -errno;
+	}
+
+	/* NB: stat(2) reports zero size for block & MTD devices */
+	len = lseek(fpd->fd, 0, SEEK_END);
+	if (len < 0) {
+		fprintf(stderr, "confile: can not detect file size: %s\n",
+			strerror(errno));
+		err = -errno;
+		goto err;
+	}
+
+	if (off >= len || (sz && sz > len - off)) {
+		fprintf(stderr, "confile: window 0x%lx+0x%lx is out of the file (0x%llx bytes)\n",
+			off, sz, (unsigned long long)len);
+		err = -EINVAL;
+		goto err;
+	}
+	if (sz && (sz < 2 || sz > 0x10000 || sz & 1)) {
+		fprintf(stderr, "confile: window size 0x%lx should be even and within 0x2...0x10000 bytes\n",
+			sz);
+		err = -EINVAL;
+		goto err;
+	}
+	if (!sz) {
+		sz = len - off;
+		if (sz > 0x10000)	/* No EEPROM bigger than 64KB */
+			sz = 0x10000;
+	}
+	if (sz < 2) {
+		fprintf(stderr, "confile: window at 0x%lx is empty\n", off);
+		err = -EINVAL;
+		goto err;
+	}
+
+	fpd->win_off = off;
+	fpd->win_sz = sz & ~1;	/* Align to 16 bit */
+
+	map_off = off & ~(pgsz - 1);
+	fpd->map_len = off - map_off + fpd->win_sz;
+	fpd->map = mmap(NULL, fpd->map_len, PROT_READ |
+			(fpd->rdonly ? 0 : PROT_WRITE), MAP_SHARED, fpd->fd,
+			map_off);
+	if (fpd->map == MAP_FAILED) {
+		/* E.g. MTD devices do not support mapping */
+		fpd->map = NULL;
+		fpd->win = NULL;
+	} else {
+		fpd->win = (uint8_t *)fpd->map + (off - map_off);
+	}
+
+	if (aem->verbose)
+		printf("confile: use 0x%04x bytes window at 0x%08lx%s%s%s\n",
+		       fpd->win_sz, off, fpd->map ? ", mapped" : "",
+		       fpd->mtd ? ", MTD" : "",
+		       fpd->rdonly ? ", read-only" : "");
+
+	return 0;
+
+err:
+	close(fpd->fd);
+	fpd->fd = -1;
+
+	return err;
+}
+
+static int file_cont_init(struct atheepmgr *aem, long *plen)
+{
+	struct file_priv *fpd = aem->con_priv;
+	struct cont_info info;
+	size_t len;
+	int err;
+
+	err = cont_load(fpd->fp, &info, &fpd->cont_buf, &len);
+	if (err)
+		return err;
+
+	if (!aem->eepmap)
+		aem->eepmap = info.eepmap;
+	aem->macVersion = info.mac_version;
+	aem->macRev = info.mac_rev;
+	fpd->cont_swap = info.io_swap;
+	*plen = len * sizeof(uint16_t);
+
+	if (aem->verbose)
+		printf("confile: container with %s EEPROM from %s, hash %016llx\n",
+		       info.eepmap->name, info.source,
+		       (unsigned long long)info.hash);
+
+	return 0;
+}
+
 static int file_init(struct atheepmgr *aem, const char *arg_str)
 {
 	struct file_priv *fpd = aem->con_priv;
+	unsigned long win_off, win_sz;
+	char fname[0x100];
 	int err;
 	long len;
 
+	fpd->fd = -1;
+	fpd->fp = NULL;
+	fpd->cont_buf = NULL;
+
+	/* Treat the argument as a window spec only if there are no such file */
+	if (access(arg_str, F_OK) != 0) {
+		snprintf(fname, sizeof(fname), "%s", arg_str);
+		if (file_parse_win(fname, &win_off, &win_sz) == 0)
+			return file_win_init(aem, fname, win_off, win_sz);
+	}
+
 	fpd->fp = fopen(arg_str, "r+b");
 	if (!fpd->fp) {
 		fprintf(stderr, "confile: can not open dump file '%s': %s\n",
@@ -115,6 +376,15 @@ static int file_init(struct atheepmgr *aem, const char *arg_str)
 		goto err;
 	}
 
+	if (cont_is_container(fpd->fp)) {
+		err = file_cont_init(aem, &len);
+		if (err) {
+			fclose(fpd->fp);
+			return err;
+		}
+		goto set_len;
+	}
+
 	if (fseek(fpd->fp, 0, SEEK_END)) {
 		fprintf(stderr, "confile: can not seek to the file end: %s\n",
 			strerror(errno));
@@ -128,6 +398,7 @@ static int file_init(struct atheepmgr *aem, const char *arg_str)
 		goto err;
 	}
 
+set_len:
 	fpd->data_len = len & ~1;	/* Align to 16 bit */
 	fpd->ic_sz = roundup_pow_of_2(fpd->data_len);
 	if (fpd->ic_sz < 0x0800)	/* Do not emulate too small IC */
@@ -152,6 +423,17 @@ static void file_clean(struct atheepmgr *aem)
 {
 	struct file_priv *fpd = aem->con_priv;
 
+	if (fpd->fd >= 0) {
+		if (fpd->map) {
+			if (!fpd->rdonly)
+				msync(fpd->map, fpd->map_len, MS_SYNC);
+			munmap(fpd->map, fpd->map_len);
+		}
+		close(fpd->fd);
+		return;
+	}
+
+	free(fpd->cont_buf);
 	fclose(fpd->fp);
 }
 
@@ -83,6 +83,7 @@ static int mem_init(struct atheepmgr *aem, const char *arg_str)
 		close(mpd->devmem_fd);
 		return -errno;
 	}
+	aem->io_size = mem_size;
 
 	return 0;
 }
@@ -20,6 +20,7 @@
 
 #include "atheepmgr.h"
 #include "con_pci.h"
+#include "trace.h"
 
 struct pci_priv {
 #if defined(__OpenBSD__)
@@ -31,55 +32,6 @@ struct pci_priv {
 	void *io_map;
 };
 
-static int is_supported_chipset(struct atheepmgr *aem, struct pci_device *pdev)
-{
-	static const struct {
-		uint16_t dev_id;
-		const char *name;
-	} devs[] = {
-		{AR5211_DEVID_PCI,  "AR5211 PCI"},
-		{AR5212_DEVID_PCI,  "AR5212/AR5213 PCI"},
-		{AR5413_DEVID_PCI,  "AR5413/AR5414 PCI"},
-		{AR5416_DEVID_PCI,  "AR5416 PCI"},
-		{AR5416_DEVID_PCIE, "AR5416 PCIe"},
-		{AR9160_DEVID_PCI,  "AR9160 PCI"},
-		{AR9280_DEVID_PCI,  "AR9280 PCI"},
-		{AR9280_DEVID_PCIE, "AR9280 PCIe"},
-		{AR9285_DEVID_PCIE, "AR9285 PCIe"},
-		{AR9287_DEVID_PCI,  "AR9287 PCI"},
-		{AR9287_DEVID_PCIE, "AR9287 PCIe"},
-		{AR9300_DEVID_PCIE, "AR9300 PCIe"},
-		{AR9485_DEVID_PCIE, "AR9485 PCIe"},
-		{AR9580_DEVID_PCIE, "AR9580 PCIe"},
-		{AR9462_DEVID_PCIE, "AR9462 PCIe"},
-		{AR9565_DEVID_PCIE, "AR9565 PCIe"},
-		{AR1111_DEVID_PCIE, "AR1111 PCIe"},
-	};
-	int i;
-
-	if (pdev->vendor_id != ATHEROS_VENDOR_ID)
-		goto not_supported;
-
-	for (i = 0; i < ARRAY_SIZE(devs); ++i)
-		if (devs[i].dev_id == pdev->device_id)
-			break;
-
-	if (i == ARRAY_SIZE(devs))
-		goto not_supported;
-
-	if (aem->verbose)
-		printf("Found Device: %04x:%04x (%s)\n", pdev->vendor_id,
-			pdev->device_id, devs[i].name);
-
-	return 1;
-
-not_supported:
-	fprintf(stderr, "Device: %04x:%04x not supported\n",
-		pdev->vendor_id, pdev->device_id);
-
-	return 0;
-}
-
 static int pci_device_init(struct atheepmgr *aem, struct pci_device *pdev)
 {
 	struct pci_priv *ppd = aem->con_priv;
@@ -119,6 +71,8 @@ static int pci_device_init(struct atheepmgr *aem, struct pci_device *pdev)
 	if (aem->verbose)
 		printf("Mapped IO region at: %p\n", ppd->io_map);
 
+	aem->io_size = ppd->size;
+
 	return 0;
 }
 
@@ -210,7 +164,9 @@ static int pci_init(struct atheepmgr *aem, const char *arg_str)
 		return -EINVAL;
 	}
 
+	trace_begin(aem, "pci_system_init", NULL);
 	ret = pci_system_init();
+	trace_end(aem, "pci_system_init", ret);
 	if (ret) {
 		fprintf(stderr, "PCI sys init error: %s\n", strerror(ret));
 		goto err;
@@ -240,7 +196,7 @@ static int pci_init(struct atheepmgr *aem, const char *arg_str)
 		goto err;
 	}
 
-	if (!is_supported_chipset(aem, pdev)) {
+	if (!pci_is_supported_chipset(aem, pdev->vendor_id, pdev->device_id)) {
 		ret = ENOTSUP;
 		goto err;
 	}
@@ -36,4 +36,7 @@
 #define AR9565_DEVID_PCIE	0x0036
 #define AR1111_DEVID_PCIE	0x0037
 
+int pci_is_supported_chipset(struct atheepmgr *aem, uint16_t vendor_id,
+			     uint16_t device_id);
+
 #endif	/* CON_PCI_H */
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <limits.h>
+
+#include "atheepmgr.h"
+#include "con_pci.h"
+
+#define SYSFS_PCI_DEVICES	"/sys/bus/pci/devices"
+
+struct sysfs_priv {
+	int res_fd;
+	size_t size;
+	void *io_map;
+};
+
+static uint32_t sysfs_reg_read(struct atheepmgr *aem, uint32_t reg)
+{
+	struct sysfs_priv *spd = aem->con_priv;
+
+	return *((volatile uint32_t *)(spd->io_map + reg));
+}
+
+static void sysfs_reg_write(struct atheepmgr *aem, uint32_t reg, uint32_t val)
+{
+	struct sysfs_priv *spd = aem->con_priv;
+
+	*((volatile uint32_t *)(spd->io_map + reg)) = val;
+}
+
+static void sysfs_reg_rmw(struct atheepmgr *aem, uint32_t reg, uint32_t set,
+			  uint32_t clr)
+{
+	struct sysfs_priv *spd = aem->con_priv;
+	uint32_t tmp;
+
+	tmp = *((volatile uint32_t *)(spd->io_map + reg));
+	tmp &= ~clr;
+	tmp |= set;
+	*((volatile uint32_t *)(spd->io_map + reg)) = tmp;
+}
+
+/**
+ * Build the device sysfs directory path from the slot specification, which
+ * is accepted in the same form as for the libpciaccess connector (function
+ * 0 is used if it is omitted) or as a path to the device directory itself.
+ */
+static int sysfs_parse_devarg(const char *str, char *path, size_t sz)
+{
+	unsigned domain = 0, bus, dev, func = 0;
+	int num, len;
+
+	if (strchr(str, '/')) {
+		snprintf(path, sz, "%s", str);
+		return 0;
+	}
+
+	num = sscanf(str, "%x:%x:%x.%u%n", &domain, &bus, &dev, &func, &len);
+	if (num == 4 && str[len] == '\0')
+		goto done;
+
+	num = sscanf(str, "%x:%x:%x%n", &domain, &bus, &dev, &len);
+	if (num == 3 && str[len] == '\0')
+		goto done;
+
+	domain = 0;
+	num = sscanf(str, "%x:%x.%u%n", &bus, &dev, &func, &len);
+	if (num == 3 && str[len] == '\0')
+		goto done;
+
+	func = 0;
+	num = sscanf(str, "%x:%x%n", &bus, &dev, &len);
+	if (num == 2 && str[len] == '\0')
+		goto done;
+
+	return -1;
+
+done:
+	snprintf(path, sz, SYSFS_PCI_DEVICES "/%04x:%02x:%02x.%u", domain, bus,
+		 dev, func);
+
+	return 0;
+}
+
+static int sysfs_read_id(const char *devpath, const char *name, uint16_t *id)
+{
+	char path[PATH_MAX];
+	unsigned long val;
+	FILE *fp;
+	int num;
+
+	snprintf(path, sizeof(path), "%s/%s", devpath, name);
+	fp = fopen(path, "r");
+	if (!fp) {
+		fprintf(stderr, "consysfs: unable to open %s: %s\n", path,
+			strerror(errno));
+		return -errno;
+	}
+	num = fscanf(fp, "%lx", &val);
+	fclose(fp);
+	if (num != 1 || val > 0xffff) {
+		fprintf(stderr, "consysfs: invalid content of %s\n", path);
+		return -EINVAL;
+	}
+	*id = val;
+
+	return 0;
+}
+
+static int sysfs_init(struct atheepmgr *aem, const char *arg_str)
+{
+	struct sysfs_priv *spd = aem->con_priv;
+	char devpath[0x200], path[0x220];
+	uint16_t vendor_id, device_id;
+	struct stat st;
+	int ret;
+
+	if (sysfs_parse_devarg(arg_str, devpath, sizeof(devpath)) != 0) {
+		fprintf(stderr, "consysfs: invalid PCI slot specification -- %s\n",
+			arg_str);
+		return -EINVAL;
+	}
+
+	ret = sysfs_read_id(devpath, "vendor", &vendor_id);
+	if (ret)
+		return ret;
+	ret = sysfs_read_id(devpath, "device", &device_id);
+	if (ret)
+		return ret;
+
+	if (!pci_is_supported_chipset(aem, vendor_id, device_id))
+		return -ENOTSUP;
+
+	snprintf(path, sizeof(path), "%s/resource0", devpath);
+	spd->res_fd = open(path, O_RDWR | O_SYNC);
+	if (spd->res_fd < 0) {
+		fprintf(stderr, "consysfs: opening %s failed: %s\n", path,
+			strerror(errno));
+		return -errno;
+	}
+
+	if (fstat(spd->res_fd, &st) != 0 || st.st_size == 0) {
+		fprintf(stderr, "consysfs: unable to determine %s size\n", path);
+		ret = -EINVAL;
+		goto err;
+	}
+	spd->size = st.st_size;
+
+	spd->io_map = mmap(NULL, spd->size, PROT_READ | PROT_WRITE, MAP_SHARED,
+			   spd->res_fd, 0);
+	if (MAP_FAILED == spd->io_map) {
+		fprintf(stderr, "consysfs: mmap of %s for 0x%08lx bytes failed: %s\n",
+			path, (unsigned long)spd->size, strerror(errno));
+		ret = -errno;
+		goto err;
+	}
+
+	if (aem->verbose)
+		printf("Mapped %s (0x%08lx bytes) at: %p\n", path,
+		       (unsigned long)spd->size, spd->io_map);
+
+	aem->io_size = spd->size;
+
+	return 0;
+
+err:
+	close(spd->res_fd);
+
+	return ret;
+}
+
+static void sysfs_clean(struct atheepmgr *aem)
+{
+	struct sysfs_priv *spd = aem->con_priv;
+
+	munmap(spd->io_map, spd->size);
+	close(spd->res_fd);
+}
+
+const struct connector con_sysfs = {
+	.name = "Sysfs",
+	.priv_data_sz = sizeof(struct sysfs_priv),
+	.caps = CON_CAP_HW,
+	.init = sysfs_init,
+	.clean = sysfs_clean,
+	.reg_read = sysfs_reg_read,
+	.reg_write = sysfs_reg_write,
+	.reg_rmw = sysfs_reg_rmw,
+};
@@ -0,0 +1,292 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <time.h>
+
+#include "atheepmgr.h"
+#include "utils.h"
+#include "container.h"
+
+uint64_t cont_hash(const uint16_t *buf, size_t len)
+{
+	uint64_t hash = FNV1A64_INIT;
+	uint16_t word;
+	size_t i;
+
+	/* Hash is calculated over the little-endian data */
+	for (i = 0; i < len; ++i) {
+		word = htole16(buf[i]);
+		hash = fnv1a64(hash, &word, sizeof(word));
+	}
+
+	return hash;
+}
+
+bool cont_is_container(FILE *fp)
+{
+	char magic[CONT_MAGIC_LEN];
+	size_t res;
+
+	res = fread(magic, 1, sizeof(magic), fp);
+	rewind(fp);
+
+	return res == sizeof(magic) &&
+	       memcmp(magic, CONT_MAGIC, CONT_MAGIC_LEN) == 0;
+}
+
+/* Find the next run of the non-empty words, returns the run length */
+static size_t cont_run_find(const uint16_t *buf, size_t len, size_t *pos)
+{
+	size_t start, end, gap;
+
+	for (start = *pos; start < len && buf[start] == 0xffff; ++start);
+	if (start == len)
+		return 0;
+
+	for (end = start; end < len; ) {
+		if (buf[end] != 0xffff) {
+			end++;
+			continue;
+		}
+		for (gap = end; gap < len && buf[gap] == 0xffff; ++gap);
+		if (gap == len || gap - end >= CONT_RUN_GAP_MIN)
+			break;
+		end = gap;		/* Merge short gap into the run */
+	}
+
+	*pos = start;
+
+	return end - start;
+}
+
+int cont_save(struct atheepmgr *aem, const char *fname)
+{
+	const uint16_t *buf = aem->eep_buf;
+	size_t len = aem->eep_len;
+	struct cont_hdr hdr;
+	struct cont_run run;
+	size_t pos, rlen, i;
+	uint16_t word;
+	int nruns = 0;
+	FILE *fp;
+
+	if (len > 0xffff) {
+		fprintf(stderr, "EEPROM data is too big for the container\n");
+		return -EINVAL;
+	}
+
+	for (pos = 0; (rlen = cont_run_find(buf, len, &pos)) != 0; pos += rlen)
+		nruns++;
+
+	memset(&hdr, 0x00, sizeof(hdr));
+	memcpy(hdr.magic, CONT_MAGIC, CONT_MAGIC_LEN);
+	hdr.version = CONT_VERSION;
+	hdr.flags = aem->eep_io_swap ? CONT_F_IO_SWAP : 0;
+	hdr.hdr_len = htole16(sizeof(hdr));
+	memcpy(hdr.eepmap, aem->eepmap->name,
+	       strnlen(aem->eepmap->name, sizeof(hdr.eepmap)));
+	hdr.mac_version = htole32(aem->macVersion);
+	hdr.mac_rev = htole16(aem->macRev);
+	hdr.nruns = htole16(nruns);
+	hdr.timestamp = htole64(time(NULL));
+	hdr.hash = htole64(cont_hash(buf, len));
+	hdr.eep_len = htole32(len);
+	snprintf(hdr.source, sizeof(hdr.source), "%s:%s", aem->con->name,
+		 aem->con_arg ? aem->con_arg : "");
+
+	fp = fopen(fname, "wb");
+	if (!fp) {
+		fprintf(stderr, "Unable to open output file for writing: %s\n",
+			strerror(errno));
+		return -errno;
+	}
+
+	if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1)
+		goto err;
+
+	for (pos = 0; (rlen = cont_run_find(buf, len, &pos)) != 0; pos += rlen) {
+		run.off = htole16(pos);
+		run.len = htole16(rlen);
+		if (fwrite(&run, sizeof(run), 1, fp) != 1)
+			goto err;
+		for (i = pos; i < pos + rlen; ++i) {
+			word = htole16(buf[i]);
+			if (fwrite(&word, sizeof(word), 1, fp) != 1)
+				goto err;
+		}
+	}
+
+	if (aem->verbose)
+		printf("Saved %zu words in %d run(s), %ld bytes total\n", len,
+		       nruns, ftell(fp));
+
+	fclose(fp);
+
+	return 0;
+
+err:
+	fprintf(stderr, "Unable to save EEPROM contents: %s\n",
+		strerror(errno));
+	fclose(fp);
+
+	return -EIO;
+}
+
+int cont_load(FILE *fp, struct cont_info *info, uint16_t **pbuf, size_t *plen)
+{
+	struct cont_hdr hdr;
+	struct cont_run run;
+	uint16_t *buf = NULL;
+	size_t len, off, i;
+	char name[sizeof(hdr.eepmap) + 1];
+	int nruns;
+
+	if (fread(&hdr, sizeof(hdr), 1, fp) != 1 ||
+	    memcmp(hdr.magic, CONT_MAGIC, CONT_MAGIC_LEN) != 0) {
+		fprintf(stderr, "container: invalid file header\n");
+		return -EINVAL;
+	}
+	if (hdr.version != CONT_VERSION) {
+		fprintf(stderr, "container: unsupported format version %u\n",
+			hdr.version);
+		return -EINVAL;
+	}
+	if (le16toh(hdr.hdr_len) < sizeof(hdr) ||
+	    fseek(fp, le16toh(hdr.hdr_len), SEEK_SET) != 0) {
+		fprintf(stderr, "container: invalid header length\n");
+		return -EINVAL;
+	}
+
+	memcpy(name, hdr.eepmap, sizeof(hdr.eepmap));
+	name[sizeof(hdr.eepmap)] = '\0';
+	info->eepmap = eepmap_find_by_name(name);
+	if (!info->eepmap) {
+		fprintf(stderr, "container: unknown EEPROM map '%s'\n", name);
+		return -EINVAL;
+	}
+	info->mac_version = le32toh(hdr.mac_version);
+	info->mac_rev = le16toh(hdr.mac_rev);
+	info->io_swap = !!(hdr.flags & CONT_F_IO_SWAP);
+	info->timestamp = le64toh(hdr.timestamp);
+	info->hash = le64toh(hdr.hash);
+	memcpy(info->source, hdr.source, sizeof(hdr.source));
+	info->source[sizeof(hdr.source)] = '\0';
+
+	len = le32toh(hdr.eep_len);
+	if (len > 0xffff) {
+		fprintf(stderr, "container: invalid data length\n");
+		return -EINVAL;
+	}
+
+	buf = malloc((len ? len : 1) * sizeof(uint16_t));
+	if (!buf) {
+		fprintf(stderr, "container: unable to allocate memory\n");
+		return -ENOMEM;
+	}
+	for (i = 0; i < len; ++i)
+		buf[i] = 0xffff;
+
+	for (nruns = le16toh(hdr.nruns); nruns > 0; --nruns) {
+		if (fread(&run, sizeof(run), 1, fp) != 1)
+			goto err_io;
+		off = le16toh(run.off);
+		if (off + le16toh(run.len) > len) {
+			fprintf(stderr, "container: data run is out of the EEPROM\n");
+			goto err;
+		}
+		if (fread(&buf[off], sizeof(uint16_t), le16toh(run.len), fp) !=
+		    le16toh(run.len))
+			goto err_io;
+		for (i = off; i < off + le16toh(run.len); ++i)
+			buf[i] = le16toh(buf[i]);
+	}
+
+	if (cont_hash(buf, len) != info->hash) {
+		fprintf(stderr, "container: content hash mismatch\n");
+		goto err;
+	}
+
+	*pbuf = buf;
+	*plen = len;
+
+	return 0;
+
+err_io:
+	fprintf(stderr, "container: unexpected end of file\n");
+err:
+	free(buf);
+
+	return -EINVAL;
+}
+
+/**
+ * Load EEPROM image either from the container or from the raw dump file. In
+ * the last case the info eepmap field is NULL and the data are returned
+ * as is (without any byteswapping).
+ */
+int cont_load_image(const char *fname, struct cont_info *info, uint16_t **pbuf,
+		    size_t *plen)
+{
+	uint16_t *buf;
+	FILE *fp;
+	long len;
+	int ret;
+
+	fp = fopen(fname, "rb");
+	if (!fp) {
+		fprintf(stderr, "Unable to open image file '%s': %s\n", fname,
+			strerror(errno));
+		return -errno;
+	}
+
+	if (cont_is_container(fp)) {
+		ret = cont_load(fp, info, pbuf, plen);
+		fclose(fp);
+		return ret;
+	}
+
+	memset(info, 0x00, sizeof(*info));
+
+	if (fseek(fp, 0, SEEK_END) != 0 || (len = ftell(fp)) < 0) {
+		fprintf(stderr, "Unable to detect image size: %s\n",
+			strerror(errno));
+		fclose(fp);
+		return -EIO;
+	}
+	rewind(fp);
+
+	len /= sizeof(uint16_t);
+	buf = malloc((len ? len : 1) * sizeof(uint16_t));
+	if (!buf) {
+		fprintf(stderr, "Unable to allocate memory for the image\n");
+		fclose(fp);
+		return -ENOMEM;
+	}
+
+	if (fread(buf, sizeof(uint16_t), len, fp) != len) {
+		fprintf(stderr, "Unable to read image: %s\n", strerror(errno));
+		free(buf);
+		fclose(fp);
+		return -EIO;
+	}
+	fclose(fp);
+
+	info->hash = cont_hash(buf, len);
+	*pbuf = buf;
+	*plen = len;
+
+	return 0;
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef CONTAINER_H
+#define CONTAINER_H
+
+/**
+ * EEPROM dump container file layout (all fields are little-endian):
+ *
+ *   header (struct cont_hdr)
+ *   run #0 header (struct cont_run), run #0 data words
+ *   ...
+ *   run #N-1 header, run #N-1 data words
+ *
+ * Each run describes a range of the EEPROM words, which are not equal to
+ * 0xffff (with short 0xffff gaps merged to avoid the run header overhead).
+ * Words outside of any run are 0xffff. Words are stored in the host byte
+ * order of the parser, i.e. after the byteswapping (if any), the original
+ * storage byte order is preserved by the CONT_F_IO_SWAP flag.
+ */
+
+#define CONT_MAGIC		"AEMC"
+#define CONT_MAGIC_LEN		4
+#define CONT_VERSION		1
+
+#define CONT_F_IO_SWAP		0x01	/* EEPROM data are stored byteswapped */
+
+#define CONT_RUN_GAP_MIN	3	/* Minimal gap length to split a run */
+
+struct cont_hdr {
+	char magic[CONT_MAGIC_LEN];
+	uint8_t version;
+	uint8_t flags;
+	uint16_t hdr_len;		/* Header length, bytes */
+	char eepmap[8];			/* EEPROM map name */
+	uint32_t mac_version;
+	uint16_t mac_rev;
+	uint16_t nruns;			/* Number of data runs */
+	uint64_t timestamp;		/* Saving time, seconds since Epoch */
+	uint64_t hash;			/* FNV-1a hash of the EEPROM content */
+	uint32_t eep_len;		/* EEPROM data length, words */
+	char source[36];		/* Source connector and its argument */
+} __attribute__ ((packed));
+
+struct cont_run {
+	uint16_t off;			/* Run offset, words */
+	uint16_t len;			/* Run length, words */
+} __attribute__ ((packed));
+
+/* Container properties in the host byte order */
+struct cont_info {
+	const struct eepmap *eepmap;
+	uint32_t mac_version;
+	uint16_t mac_rev;
+	int io_swap;
+	uint64_t timestamp;
+	uint64_t hash;
+	char source[sizeof(((struct cont_hdr *)0)->source) + 1];
+};
+
+uint64_t cont_hash(const uint16_t *buf, size_t len);
+bool cont_is_container(FILE *fp);
+int cont_save(struct atheepmgr *aem, const char *fname);
+int cont_load(FILE *fp, struct cont_info *info, uint16_t **buf, size_t *len);
+int cont_load_image(const char *fname, struct cont_info *info, uint16_t **buf,
+		    size_t *len);
+
+#endif	/* CONTAINER_H */
@@ -920,28 +920,16 @@ static void eep_5211_fill_ctl_data_33(struct atheepmgr *aem)
 	}
 }
 
-static bool eep_5211_fill(struct atheepmgr *aem)
+/* Fetch the EEPROM data length, words */
+static int eep_5211_read_len(struct atheepmgr *aem)
 {
-	struct eep_5211_priv *emp = aem->eepmap_priv;
-	struct ar5211_eeprom *eep = &emp->eep;
-	struct ar5211_base_eep_hdr *base = &eep->base;
 	uint16_t endloc_up, endloc_lo;
-	uint16_t magic;
-	int len = 0, addr;
-	uint16_t *buf = aem->eep_buf;
-
-	/* RAW magic reading with subsequent swaping requirement check */
-	if (!EEP_READ(AR5211_EEP_MAGIC, &magic)) {
-		fprintf(stderr, "EEPROM magic read failed\n");
-		return false;
-	}
-	if (bswap_16(magic) == htole16(AR5211_EEPROM_MAGIC_VAL))
-		aem->eep_io_swap = !aem->eep_io_swap;
+	int len = 0;
 
 	if (!EEP_READ(AR5211_EEP_ENDLOC_UP, &endloc_up) ||
 	    !EEP_READ(AR5211_EEP_ENDLOC_LO, &endloc_lo)) {
 		fprintf(stderr, "Unable to read EEPROM size\n");
-		return false;
+		return -1;
 	}
 
 	if (endloc_up) {
@@ -963,6 +951,30 @@ static bool eep_5211_fill(struct atheepmgr *aem)
 		len = AR5211_SIZE_DEF;
 	}
 
+	return len;
+}
+
+static bool eep_5211_fill(struct atheepmgr *aem)
+{
+	struct eep_5211_priv *emp = aem->eepmap_priv;
+	struct ar5211_eeprom *eep = &emp->eep;
+	struct ar5211_base_eep_hdr *base = &eep->base;
+	uint16_t magic;
+	int len, addr;
+	uint16_t *buf = aem->eep_buf;
+
+	/* RAW magic reading with subsequent swaping requirement check */
+	if (!EEP_READ(AR5211_EEP_MAGIC, &magic)) {
+		fprintf(stderr, "EEPROM magic read failed\n");
+		return false;
+	}
+	if (bswap_16(magic) == htole16(AR5211_EEPROM_MAGIC_VAL))
+		aem->eep_io_swap = !aem->eep_io_swap;
+
+	len = eep_5211_read_len(aem);
+	if (len < 0)
+		return false;
+
 	/* Read to intermediated buffer */
 	for (addr = 0; addr < len; ++addr, ++buf) {
 		if (!EEP_READ(addr, buf)) {
@@ -1479,12 +1491,13 @@ static bool eep_5211_update_eeprom(struct atheepmgr *aem, int param,
 #endif
 	uint16_t *buf = aem->eep_buf;
 	int data_pos, data_len = 0, addr, el, i;
-	uint16_t sum;
+	uint16_t sum, orig[AR5211_NUM_CTLS_MAX / 2];
 
 	switch (param) {
 	case EEP_UPDATE_MAC:
 		data_pos = AR5211_EEP_MAC;
 		data_len = 6 / sizeof(uint16_t);
+		memcpy(orig, &buf[data_pos], data_len * sizeof(uint16_t));
 		for (i = 0; i < 6; ++i) {
 			((uint8_t *)(buf + AR5211_EEP_MAC))[5 - i] =
 							((uint8_t *)data)[i];
@@ -1496,6 +1509,7 @@ static bool eep_5211_update_eeprom(struct atheepmgr *aem, int param,
 		data_pos = base->version >= AR5211_EEP_VER_3_3 ?
 			   AR5211_EEP_CTL_INDEX_33 : AR5211_EEP_CTL_INDEX_30;
 		data_len = emp->param.ctls_num / 2;
+		memcpy(orig, &buf[data_pos], data_len * sizeof(uint16_t));
 		for (addr = data_pos; addr < (data_pos + data_len); ++addr)
 			buf[addr] = 0x0000;
 		break;
@@ -1507,6 +1521,8 @@ static bool eep_5211_update_eeprom(struct atheepmgr *aem, int param,
 
 	/* Store updated data */
 	for (addr = data_pos; addr < (data_pos + data_len); ++addr) {
+		if (buf[addr] == orig[addr - data_pos])
+			continue;	/* Avoid useless write */
 		if (!EEP_WRITE(addr, buf[addr])) {
 			fprintf(stderr, "Unable to write EEPROM data at 0x%04x\n",
 				addr);
@@ -1517,10 +1533,11 @@ static bool eep_5211_update_eeprom(struct atheepmgr *aem, int param,
 	/* Update checksum if need it */
 	if (data_pos > AR5211_EEP_INFO_BASE) {
 		el = aem->eep_len - AR5211_EEP_INFO_BASE;
+		orig[0] = buf[AR5211_EEP_CSUM];
 		buf[AR5211_EEP_CSUM] = 0xffff;
 		sum = eep_calc_csum(&buf[AR5211_EEP_INFO_BASE], el);
 		buf[AR5211_EEP_CSUM] = sum;
-		if (!EEP_WRITE(AR5211_EEP_CSUM, sum)) {
+		if (sum != orig[0] && !EEP_WRITE(AR5211_EEP_CSUM, sum)) {
 			fprintf(stderr, "Unable to update EEPROM checksum\n");
 			return false;
 		}
@@ -1529,6 +1546,82 @@ static bool eep_5211_update_eeprom(struct atheepmgr *aem, int param,
 	return true;
 }
 
+static void eep_5211_get_macaddr(struct atheepmgr *aem, uint8_t *mac)
+{
+	struct eep_5211_priv *emp = aem->eepmap_priv;
+
+	memcpy(mac, emp->eep.base.mac, 6);
+}
+
+static bool eep_5211_probe(struct atheepmgr *aem, struct eep_probe *res,
+			   bool csum)
+{
+	uint16_t *buf = aem->eep_buf;
+	uint16_t magic, word;
+	int len, addr, i;
+
+	if (!EEP_READ(AR5211_EEP_MAGIC, &magic)) {
+		fprintf(stderr, "EEPROM magic read failed\n");
+		return false;
+	}
+	if (bswap_16(magic) == htole16(AR5211_EEPROM_MAGIC_VAL)) {
+		aem->eep_io_swap = !aem->eep_io_swap;
+		magic = bswap_16(magic);
+	}
+	if (le16toh(magic) != AR5211_EEPROM_MAGIC_VAL) {
+		fprintf(stderr, "Invalid EEPROM Magic 0x%04x, expected 0x%04x\n",
+			le16toh(magic), AR5211_EEPROM_MAGIC_VAL);
+		return false;
+	}
+
+	/* NB: MAC address is stored in the reversed words order */
+	for (i = 0; i < 3; ++i) {
+		if (!EEP_READ(AR5211_EEP_MAC + i, &word))
+			goto err;
+		word = le16toh(word);
+		res->mac[4 - i * 2] = word >> 8;
+		res->mac[5 - i * 2] = word & 0xff;
+	}
+
+	if (!EEP_READ(AR5211_EEP_REGDOMAIN, &word))
+		goto err;
+	res->regdmn[0] = le16toh(word);
+	res->regdmn[1] = 0;
+	res->csum = -1;
+
+	if (!csum)
+		return true;
+
+	len = eep_5211_read_len(aem);
+	if (len < 0)
+		return false;
+	if (len <= AR5211_EEP_INFO_BASE) {
+		res->csum = 0;
+		return true;
+	}
+
+	for (addr = AR5211_EEP_INFO_BASE; addr < len; ++addr)
+		if (!EEP_READ(addr, &buf[addr]))
+			goto err;
+	res->csum = eep_calc_csum(&buf[AR5211_EEP_INFO_BASE],
+				  len - AR5211_EEP_INFO_BASE) == 0xffff;
+
+	return true;
+
+err:
+	fprintf(stderr, "Unable to read EEPROM\n");
+
+	return false;
+}
+
+static const struct eepmap_area eep_5211_prio_areas[] = {
+	{AR5211_EEP_CSUM, 1},
+	{AR5211_EEP_MAGIC, 1},
+	{AR5211_EEP_ENDLOC_LO, 2},
+	{AR5211_EEP_VER, 1},
+	{0, 0}
+};
+
 const struct eepmap eepmap_5211 = {
 	.name = "5211",
 	.desc = "Legacy .11abg chips EEPROM map (AR5211/AR5212/AR5414/etc.)",
@@ -1536,6 +1629,8 @@ const struct eepmap eepmap_5211 = {
 	.eep_buf_sz = AR5211_SIZE_MAX,
 	.fill_eeprom = eep_5211_fill,
 	.check_eeprom = eep_5211_check,
+	.get_macaddr = eep_5211_get_macaddr,
+	.probe = eep_5211_probe,
 	.dump = {
 		[EEP_SECT_INIT] = eep_5211_dump_init_data,
 		[EEP_SECT_BASE] = eep_5211_dump_base,
@@ -1548,4 +1643,6 @@ const struct eepmap eepmap_5211 = {
 		| BIT(EEP_ERASE_CTL)
 #endif
 	,
+	.prio_areas = eep_5211_prio_areas,
+	.csum_loc = AR5211_EEP_CSUM,
 };
@@ -563,13 +563,14 @@ static bool eep_5416_update_eeprom(struct atheepmgr *aem, int param,
 	struct ar5416_eeprom *eep = &emp->eep;
 	uint16_t *buf = aem->eep_buf;
 	int data_pos, data_len = 0, addr, el;
-	uint16_t sum;
+	uint16_t sum, orig[3];
 
 	switch (param) {
 	case EEP_UPDATE_MAC:
 		data_pos = AR5416_DATA_START_LOC +
 			   EEP_FIELD_OFFSET(baseEepHeader.macAddr);
 		data_len = EEP_FIELD_SIZE(baseEepHeader.macAddr);
+		memcpy(orig, &buf[data_pos], data_len * sizeof(uint16_t));
 		memcpy(&buf[data_pos], data, data_len * sizeof(uint16_t));
 		break;
 	default:
@@ -579,6 +580,8 @@ static bool eep_5416_update_eeprom(struct atheepmgr *aem, int param,
 
 	/* Store updated data */
 	for (addr = data_pos; addr < (data_pos + data_len); ++addr) {
+		if (buf[addr] == orig[addr - data_pos])
+			continue;	/* Avoid useless write */
 		if (!EEP_WRITE(addr, buf[addr])) {
 			fprintf(stderr, "Unable to write EEPROM data at 0x%04x\n",
 				addr);
@@ -591,10 +594,11 @@ static bool eep_5416_update_eeprom(struct atheepmgr *aem, int param,
 		el = eep->baseEepHeader.length / sizeof(uint16_t);
 		if (el > AR5416_DATA_SZ)
 			el = AR5416_DATA_SZ;
+		orig[0] = buf[AR5416_DATA_CSUM_LOC];
 		buf[AR5416_DATA_CSUM_LOC] = 0xffff;
 		sum = eep_calc_csum(&buf[AR5416_DATA_START_LOC], el);
 		buf[AR5416_DATA_CSUM_LOC] = sum;
-		if (!EEP_WRITE(AR5416_DATA_CSUM_LOC, sum)) {
+		if (sum != orig[0] && !EEP_WRITE(AR5416_DATA_CSUM_LOC, sum)) {
 			fprintf(stderr, "Unable to update EEPROM checksum\n");
 			return false;
 		}
@@ -606,6 +610,27 @@ static bool eep_5416_update_eeprom(struct atheepmgr *aem, int param,
 #undef EEP_FIELD_OFFSET
 }
 
+static void eep_5416_get_macaddr(struct atheepmgr *aem, uint8_t *mac)
+{
+	struct eep_5416_priv *emp = aem->eepmap_priv;
+
+	memcpy(mac, emp->eep.baseEepHeader.macAddr, 6);
+}
+
+static bool eep_5416_probe(struct atheepmgr *aem, struct eep_probe *res,
+			   bool csum)
+{
+	return ar5416_probe(aem, res, csum, AR5416_DATA_START_LOC, AR5416_DATA_SZ);
+}
+
+static const struct eepmap_area eep_5416_prio_areas[] = {
+	{AR5416_DATA_CSUM_LOC, 1},
+	{AR5416_DATA_START_LOC,
+	 sizeof(struct ar5416_base_eep_hdr) / sizeof(uint16_t)},
+	{AR5416_EEPROM_MAGIC_OFFSET, 1},
+	{0, 0}
+};
+
 const struct eepmap eepmap_5416 = {
 	.name = "5416",
 	.desc = "Default EEPROM map for earlier .11n chips (AR5416/AR9160/AR92xx/etc.)",
@@ -613,6 +638,8 @@ const struct eepmap eepmap_5416 = {
 	.eep_buf_sz = AR5416_DATA_START_LOC + AR5416_DATA_SZ,
 	.fill_eeprom  = eep_5416_fill,
 	.check_eeprom = eep_5416_check,
+	.get_macaddr = eep_5416_get_macaddr,
+	.probe = eep_5416_probe,
 	.dump = {
 		[EEP_SECT_INIT] = eep_5416_dump_init_data,
 		[EEP_SECT_BASE] = eep_5416_dump_base_header,
@@ -621,4 +648,6 @@ const struct eepmap eepmap_5416 = {
 	},
 	.update_eeprom = eep_5416_update_eeprom,
 	.params_mask = BIT(EEP_UPDATE_MAC),
+	.prio_areas = eep_5416_prio_areas,
+	.csum_loc = AR5416_DATA_CSUM_LOC,
 };
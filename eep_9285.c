@@ -363,6 +363,27 @@ static void eep_9285_dump_power_info(struct atheepmgr *aem)
 #undef PR_TARGET_POWER
 }
 
+static void eep_9285_get_macaddr(struct atheepmgr *aem, uint8_t *mac)
+{
+	struct eep_9285_priv *emp = aem->eepmap_priv;
+
+	memcpy(mac, emp->eep.baseEepHeader.macAddr, 6);
+}
+
+static bool eep_9285_probe(struct atheepmgr *aem, struct eep_probe *res,
+			   bool csum)
+{
+	return ar5416_probe(aem, res, csum, AR9285_DATA_START_LOC, AR9285_DATA_SZ);
+}
+
+static const struct eepmap_area eep_9285_prio_areas[] = {
+	{AR9285_DATA_START_LOC + 1, 1},		/* Checksum */
+	{AR9285_DATA_START_LOC,
+	 sizeof(struct ar9285_base_eep_hdr) / sizeof(uint16_t)},
+	{AR5416_EEPROM_MAGIC_OFFSET, 1},
+	{0, 0}
+};
+
 const struct eepmap eepmap_9285 = {
 	.name = "9285",
 	.desc = "AR9285 chip EEPROM map",
@@ -370,10 +391,14 @@ const struct eepmap eepmap_9285 = {
 	.eep_buf_sz = AR9285_DATA_START_LOC + AR9285_DATA_SZ,
 	.fill_eeprom  = eep_9285_fill,
 	.check_eeprom = eep_9285_check,
+	.get_macaddr = eep_9285_get_macaddr,
+	.probe = eep_9285_probe,
 	.dump = {
 		[EEP_SECT_INIT] = eep_9285_dump_init_data,
 		[EEP_SECT_BASE] = eep_9285_dump_base_header,
 		[EEP_SECT_MODAL] = eep_9285_dump_modal_header,
 		[EEP_SECT_POWER] = eep_9285_dump_power_info,
 	},
+	.prio_areas = eep_9285_prio_areas,
+	.csum_loc = AR9285_DATA_START_LOC + 1,
 };
@@ -368,6 +368,27 @@ static void eep_9287_dump_power_info(struct atheepmgr *aem)
 #undef PR_TARGET_POWER
 }
 
+static void eep_9287_get_macaddr(struct atheepmgr *aem, uint8_t *mac)
+{
+	struct eep_9287_priv *emp = aem->eepmap_priv;
+
+	memcpy(mac, emp->eep.baseEepHeader.macAddr, 6);
+}
+
+static bool eep_9287_probe(struct atheepmgr *aem, struct eep_probe *res,
+			   bool csum)
+{
+	return ar5416_probe(aem, res, csum, AR9287_DATA_START_LOC, AR9287_DATA_SZ);
+}
+
+static const struct eepmap_area eep_9287_prio_areas[] = {
+	{AR9287_DATA_START_LOC + 1, 1},		/* Checksum */
+	{AR9287_DATA_START_LOC,
+	 sizeof(struct ar9287_base_eep_hdr) / sizeof(uint16_t)},
+	{AR5416_EEPROM_MAGIC_OFFSET, 1},
+	{0, 0}
+};
+
 const struct eepmap eepmap_9287 = {
 	.name = "9287",
 	.desc = "AR9287 chip EEPROM map",
@@ -375,10 +396,14 @@ const struct eepmap eepmap_9287 = {
 	.eep_buf_sz = AR9287_DATA_START_LOC + AR9287_DATA_SZ,
 	.fill_eeprom  = eep_9287_fill_eeprom,
 	.check_eeprom = eep_9287_check_eeprom,
+	.get_macaddr = eep_9287_get_macaddr,
+	.probe = eep_9287_probe,
 	.dump = {
 		[EEP_SECT_INIT] = eep_9287_dump_init_data,
 		[EEP_SECT_BASE] = eep_9287_dump_base_header,
 		[EEP_SECT_MODAL] = eep_9287_dump_modal_header,
 		[EEP_SECT_POWER] = eep_9287_dump_power_info,
 	},
+	.prio_areas = eep_9287_prio_areas,
+	.csum_loc = AR9287_DATA_START_LOC + 1,
 };
@@ -18,24 +18,16 @@
 #include "atheepmgr.h"
 #include "eep_9300.h"
 #include "eep_9300_templates.h"
-
-/* Uncompressed EEPROM block header */
-struct eep_9300_blk_hdr {
-	int comp;	/* Compression type */
-	int ref;	/* Reference EEPROM data */
-	int len;	/* Block length */
-	int maj;
-	int min;
-};
+#include "trace.h"
 
 struct eep_9300_priv {
 	int valid_blocks;
+	bool probe;		/* Probe mode: fetch data on demand */
+	int probe_lo;		/* Lowest fetched word in probe mode */
+	bool base_hdr;		/* Base header is filled by a decoded block */
 	struct ar9300_eeprom eep;
 };
 
-#define COMP_HDR_LEN 4
-#define COMP_CKSUM_LEN 2
-
 #define EEPROM_DATA_LEN_9485	1088
 
 static const struct ar9300_eeprom * const ar9300_eep_templates[] = {
@@ -46,7 +38,7 @@ static const struct ar9300_eeprom * const ar9300_eep_templates[] = {
 	&ar9300_x113,
 };
 
-static const struct ar9300_eeprom *ar9300_eeprom_struct_find_by_id(int id)
+const struct ar9300_eeprom *ar9300_eeprom_struct_find_by_id(int id)
 {
 	int it;
 
@@ -79,6 +71,26 @@ static int ar9300_eep2buf(struct atheepmgr *aem, int bytes)
 	return 0;
 }
 
+/**
+ * Probe mode: fetch the EEPROM words on demand, from the top (last block)
+ * down to the specified byte address.
+ */
+static int ar9300_eep2buf_down(struct atheepmgr *aem, int addr)
+{
+	struct eep_9300_priv *emp = aem->eepmap_priv;
+	uint16_t *buf = aem->eep_buf;
+	int lo = addr < 0 ? 0 : addr / 2;
+
+	for (; emp->probe_lo > lo; emp->probe_lo--) {
+		if (!EEP_READ(emp->probe_lo - 1, &buf[emp->probe_lo - 1])) {
+			fprintf(stderr, "Unable to read EEPROM to buffer\n");
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
 /**
  * Extract bytestream of specified length from the internal buffer as specified
  * offset.
@@ -127,6 +139,8 @@ static void ar9300_buf_byteswap(struct atheepmgr *aem)
 
 static bool ar9300_otp_read_word(struct atheepmgr *aem, int addr, uint32_t *data)
 {
+	hw_read_pace(aem);
+
 	REG_READ(AR9300_OTP_BASE + (4 * addr));
 
 	if (!hw_wait(aem, AR9300_OTP_STATUS, AR9300_OTP_STATUS_TYPE,
@@ -168,7 +182,7 @@ static int ar9300_otp2buf(struct atheepmgr *aem, int bytes)
 	return 0;
 }
 
-static void ar9300_comp_hdr_unpack(uint8_t *best, struct eep_9300_blk_hdr *blkh)
+void ar9300_comp_hdr_unpack(const uint8_t *best, struct eep_9300_blk_hdr *blkh)
 {
 	unsigned long value[4];
 
@@ -183,7 +197,7 @@ static void ar9300_comp_hdr_unpack(uint8_t *best, struct eep_9300_blk_hdr *blkh)
 	blkh->min = (value[3] & 0x00ff);
 }
 
-static uint16_t ar9300_comp_cksum(uint8_t *data, int dsize)
+uint16_t ar9300_comp_cksum(const uint8_t *data, int dsize)
 {
 	int it, checksum = 0;
 
@@ -195,8 +209,10 @@ static uint16_t ar9300_comp_cksum(uint8_t *data, int dsize)
 	return checksum;
 }
 
+/* NB: the lowest restored byte offset is returned via the lo argument */
 static bool ar9300_uncompress_block(struct atheepmgr *aem, uint8_t *mptr,
-				    int mdataSize, uint8_t *block, int size)
+				    int mdataSize, uint8_t *block, int size,
+				    int *lo)
 {
 	int it;
 	int spot;
@@ -204,6 +220,7 @@ static bool ar9300_uncompress_block(struct atheepmgr *aem, uint8_t *mptr,
 	int length;
 
 	spot = 0;
+	*lo = mdataSize;
 
 	for (it = 0; it < size; it += (length+2)) {
 		offset = block[it];
@@ -217,6 +234,8 @@ static bool ar9300_uncompress_block(struct atheepmgr *aem, uint8_t *mptr,
 				printf("Restore at %d: spot=%d offset=%d length=%d\n",
 				       it, spot, offset, length);
 			memcpy(&mptr[spot], &block[it+2], length);
+			if (spot < *lo)
+				*lo = spot;
 			spot += length;
 		} else if (length > 0) {
 			fprintf(stderr,
@@ -233,8 +252,12 @@ static int ar9300_compress_decision(struct atheepmgr *aem, int it,
 				    uint8_t *mptr, uint8_t *word,
 				    int mdata_size)
 {
+	struct eep_9300_priv *emp = aem->eepmap_priv;
+	const int hdr_end = offsetof(struct ar9300_eeprom, baseEepHeader) +
+			    sizeof(emp->eep.baseEepHeader);
 	const struct ar9300_eeprom *eep = NULL;
 	bool res;
+	int lo;
 
 	switch (blkh->comp) {
 	case _CompressNone:
@@ -245,6 +268,7 @@ static int ar9300_compress_decision(struct atheepmgr *aem, int it,
 			return -1;
 		}
 		memcpy(mptr, word + COMP_HDR_LEN, blkh->len);
+		emp->base_hdr = true;
 		if (aem->verbose)
 			printf("restored eeprom %d: uncompressed, length %d\n",
 			       it, blkh->len);
@@ -263,10 +287,15 @@ static int ar9300_compress_decision(struct atheepmgr *aem, int it,
 		if (aem->verbose)
 			printf("Restore eeprom %d: block, reference %d, length %d\n",
 			       it, blkh->ref, blkh->len);
+		TRACE_PROBE2(ar9300_uncompress_enter, blkh->ref, blkh->len);
 		res = ar9300_uncompress_block(aem, mptr, mdata_size,
-					      (word + COMP_HDR_LEN), blkh->len);
+					      (word + COMP_HDR_LEN), blkh->len,
+					      &lo);
+		TRACE_PROBE1(ar9300_uncompress_exit, res);
 		if (!res)
 			return -1;
+		if (lo < hdr_end)
+			emp->base_hdr = true;
 		break;
 	default:
 		fprintf(stderr, "unknown compression code %d\n", blkh->comp);
@@ -324,12 +353,16 @@ static int ar9300_process_blocks(struct atheepmgr *aem, uint8_t *buf,
 	int it, res;
 
 	for (it = 0; it < MSTATE; it++) {
+		if (emp->probe &&
+		    ar9300_eep2buf_down(aem, cptr - COMP_HDR_LEN + 1) != 0)
+			break;
 		ar9300_buf2bstr(aem, cptr, buf, COMP_HDR_LEN);
 
 		if (!ar9300_check_header(buf))
 			break;
 
 		ar9300_comp_hdr_unpack(buf, &blkh);
+		TRACE_PROBE3(ar9300_block, cptr, blkh.comp, blkh.len);
 		if (aem->verbose)
 			printf("Found block at %x: comp=%d ref=%d length=%d major=%d minor=%d\n",
 			       cptr, blkh.comp, blkh.ref, blkh.len, blkh.maj,
@@ -341,6 +374,10 @@ static int ar9300_process_blocks(struct atheepmgr *aem, uint8_t *buf,
 			continue;
 		}
 
+		if (emp->probe &&
+		    ar9300_eep2buf_down(aem, cptr - (COMP_HDR_LEN + blkh.len +
+						     COMP_CKSUM_LEN) + 1) != 0)
+			break;
 		ar9300_buf2bstr(aem, cptr, buf,
 				COMP_HDR_LEN + blkh.len + COMP_CKSUM_LEN);
 
@@ -362,6 +399,10 @@ static int ar9300_process_blocks(struct atheepmgr *aem, uint8_t *buf,
 			emp->valid_blocks++;
 
 		cptr -= COMP_HDR_LEN + blkh.len + COMP_CKSUM_LEN;
+
+		/* Stop probing as soon as the base header is populated */
+		if (emp->probe && emp->base_hdr)
+			break;
 	}
 
 	return prev_valid_blocks == emp->valid_blocks ? -1 : 0;
@@ -386,6 +427,8 @@ static bool eep_9300_fill(struct atheepmgr *aem)
 	}
 
 	memcpy(&emp->eep, &ar9300_default, sizeof(emp->eep));
+	emp->valid_blocks = 0;
+	aem->eep_otp = false;
 
 parse_eeprom:
 	if (ar9300_eep2buf(aem, sizeof(struct ar9300_eeprom)) != 0)
@@ -432,6 +475,7 @@ parse_eeprom:
 		goto fail;
 
 	aem->eep_len = 0;	/* Reset internal buffer contents */
+	aem->eep_otp = true;
 
 	cptr = AR9300_BASE_ADDR;
 	if (aem->verbose)
@@ -466,6 +510,13 @@ static int eep_9300_check(struct atheepmgr *aem)
 	return emp->valid_blocks ? 1 : 0;
 }
 
+static int eep_9300_valid_blocks(struct atheepmgr *aem)
+{
+	struct eep_9300_priv *emp = aem->eepmap_priv;
+
+	return emp->valid_blocks;
+}
+
 static void eep_9300_dump_base_header(struct atheepmgr *aem)
 {
 	struct eep_9300_priv *emp = aem->eepmap_priv;
@@ -777,6 +828,74 @@ static void eep_9300_dump_power_info(struct atheepmgr *aem)
 	}
 }
 
+static void eep_9300_get_macaddr(struct atheepmgr *aem, uint8_t *mac)
+{
+	struct eep_9300_priv *emp = aem->eepmap_priv;
+
+	memcpy(mac, emp->eep.macAddr, 6);
+}
+
+/**
+ * Decode the compressed blocks from the top of the EEPROM only up to the
+ * block, which populates the base header, instead of the whole EEPROM
+ * fetching. Fall back to the full fetching if nothing is found this way
+ * (e.g. in case of the uncompressed, byteswapped or OTP stored data).
+ */
+static bool eep_9300_probe(struct atheepmgr *aem, struct eep_probe *res,
+			   bool csum)
+{
+	struct eep_9300_priv *emp = aem->eepmap_priv;
+	const int cptrs[] = {
+		AR_SREV_9485(aem) ? AR9300_BASE_ADDR_4K :
+		AR_SREV_9330(aem) ? AR9300_BASE_ADDR_512 : AR9300_BASE_ADDR,
+		AR9300_BASE_ADDR_512,
+	};
+	uint8_t *word;
+	int i, ret = -1;
+
+	word = calloc(1, 2048);
+	if (!word) {
+		fprintf(stderr, "Unable to allocate temporary buffer\n");
+		return false;
+	}
+
+	memcpy(&emp->eep, &ar9300_default, sizeof(emp->eep));
+	emp->valid_blocks = 0;
+	emp->base_hdr = false;
+
+	emp->probe = true;
+	emp->probe_lo = aem->eep_len = cptrs[0] / 2 + 1;
+	for (i = 0; i < ARRAY_SIZE(cptrs) && ret != 0; ++i) {
+		if (aem->verbose)
+			printf("Probing EEPROM at Address 0x%04x\n", cptrs[i]);
+		ret = ar9300_process_blocks(aem, word, cptrs[i]);
+	}
+	emp->probe = false;
+	free(word);
+
+	if (ret != 0) {
+		if (aem->verbose)
+			printf("No block found by probing, fetch the whole EEPROM\n");
+		aem->eep_len = 0;
+		if (!eep_9300_fill(aem) || !eep_9300_check(aem))
+			return false;
+	}
+
+	memcpy(res->mac, emp->eep.macAddr, sizeof(res->mac));
+	res->regdmn[0] = le16toh(emp->eep.baseEepHeader.regDmn[0]);
+	res->regdmn[1] = le16toh(emp->eep.baseEepHeader.regDmn[1]);
+	/* NB: probed blocks are verified by their own checksums */
+	res->csum = ret == 0 ? 1 : -1;
+
+	return true;
+}
+
+/* Blocks are stored from the EEPROM top down, so the first one is read first */
+static const struct eepmap_area eep_9300_prio_areas[] = {
+	{(AR9300_BASE_ADDR - COMP_HDR_LEN) / 2 + 1, 2},	/* 1st block hdr */
+	{0, 0}
+};
+
 const struct eepmap eepmap_9300 = {
 	.name = "9300",
 	.desc = "EEPROM map for modern .11n chips (AR93xx/AR64xx/AR95xx/etc.)",
@@ -784,9 +903,13 @@ const struct eepmap eepmap_9300 = {
 	.eep_buf_sz = AR9300_EEPROM_SIZE / sizeof(uint16_t),
 	.fill_eeprom = eep_9300_fill,
 	.check_eeprom = eep_9300_check,
+	.get_macaddr = eep_9300_get_macaddr,
+	.probe = eep_9300_probe,
 	.dump = {
 		[EEP_SECT_BASE] = eep_9300_dump_base_header,
 		[EEP_SECT_MODAL] = eep_9300_dump_modal_header,
 		[EEP_SECT_POWER] = eep_9300_dump_power_info,
 	},
+	.prio_areas = eep_9300_prio_areas,
+	.valid_blocks = eep_9300_valid_blocks,
 };
@@ -58,6 +58,9 @@
 #define AR9300_OTP_STATUS_SM_BUSY	0x1
 #define AR9300_OTP_READ_DATA		0x15f1c
 
+#define COMP_HDR_LEN 4
+#define COMP_CKSUM_LEN 2
+
 struct ar9300_eepFlags {
 	uint8_t opFlags;
 	uint8_t eepMisc;
@@ -239,4 +242,17 @@ struct ar9300_eeprom {
 	struct ar9300_cal_ctl_data_5g ctlPowerData_5G[AR9300_NUM_CTLS_5G];
 } __attribute__ ((packed));
 
+/* Uncompressed EEPROM block header */
+struct eep_9300_blk_hdr {
+	int comp;	/* Compression type */
+	int ref;	/* Reference EEPROM data */
+	int len;	/* Block length */
+	int maj;
+	int min;
+};
+
+const struct ar9300_eeprom *ar9300_eeprom_struct_find_by_id(int id);
+void ar9300_comp_hdr_unpack(const uint8_t *best, struct eep_9300_blk_hdr *blkh);
+uint16_t ar9300_comp_cksum(const uint8_t *data, int dsize);
+
 #endif
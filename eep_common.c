@@ -16,6 +16,7 @@
  */
 
 #include "atheepmgr.h"
+#include "eep_5211.h"
 
 const char * const sDeviceType[] = {
 	"UNKNOWN [0] ",
@@ -164,3 +165,100 @@ uint16_t eep_calc_csum(const uint16_t *buf, size_t len)
 
 	return csum;
 }
+
+/**
+ * Detect the device EEPROM data byte order by comparing the magic word of the
+ * reference image with the device one. Since the EEPROM map type could be
+ * unknown, try both AR5416 and AR5211 magic locations.
+ */
+void eep_detect_io_swap(struct atheepmgr *aem, const uint16_t *buf, size_t len)
+{
+	static const struct {
+		uint32_t off;
+		uint16_t magic;
+	} magics[] = {
+		{AR5416_EEPROM_MAGIC_OFFSET, AR5416_EEPROM_MAGIC},
+		{AR5211_EEP_MAGIC, AR5211_EEPROM_MAGIC_VAL},
+	};
+	uint16_t word;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(magics); ++i) {
+		if (magics[i].off >= len || buf[magics[i].off] != magics[i].magic)
+			continue;
+		if (!EEP_READ(magics[i].off, &word))
+			continue;
+		if (word == bswap_16(magics[i].magic)) {
+			aem->eep_io_swap = !aem->eep_io_swap;
+			if (aem->verbose)
+				printf("Device EEPROM data are byteswapped\n");
+		}
+		return;
+	}
+}
+
+/**
+ * Probe the AR5416 family EEPROM (AR5416/AR9285/AR9287 maps), these maps
+ * share the same base header beginning, so only a dozen of words should be
+ * read. The checksummed area is read only if the validation is requested.
+ */
+bool ar5416_probe(struct atheepmgr *aem, struct eep_probe *res, bool csum,
+		  uint32_t data_start, size_t data_sz)
+{
+	const size_t hl = sizeof(struct ar5416_base_eep_hdr_head) /
+			  sizeof(uint16_t);
+	uint16_t magic, *buf = aem->eep_buf + data_start;
+	struct ar5416_base_eep_hdr_head hdr;
+	size_t el;
+	int i;
+
+	if (!EEP_READ(AR5416_EEPROM_MAGIC_OFFSET, &magic)) {
+		fprintf(stderr, "EEPROM magic read failed\n");
+		return false;
+	}
+	if (bswap_16(magic) == AR5416_EEPROM_MAGIC) {
+		aem->eep_io_swap = !aem->eep_io_swap;
+		magic = bswap_16(magic);
+	}
+	if (magic != AR5416_EEPROM_MAGIC) {
+		fprintf(stderr, "Invalid EEPROM Magic 0x%04x, expected 0x%04x\n",
+			magic, AR5416_EEPROM_MAGIC);
+		return false;
+	}
+
+	for (i = 0; i < hl; ++i) {
+		if (!EEP_READ(data_start + i, &buf[i])) {
+			fprintf(stderr, "Unable to read EEPROM base header\n");
+			return false;
+		}
+	}
+	memcpy(&hdr, buf, sizeof(hdr));
+
+	if (!!(hdr.eepMisc & AR5416_EEPMISC_BIG_ENDIAN) != aem->host_is_be) {
+		hdr.length = bswap_16(hdr.length);
+		hdr.regDmn[0] = bswap_16(hdr.regDmn[0]);
+		hdr.regDmn[1] = bswap_16(hdr.regDmn[1]);
+	}
+
+	memcpy(res->mac, hdr.macAddr, sizeof(res->mac));
+	res->regdmn[0] = hdr.regDmn[0];
+	res->regdmn[1] = hdr.regDmn[1];
+	res->csum = -1;
+
+	if (!csum)
+		return true;
+
+	el = hdr.length / sizeof(uint16_t);
+	if (el > data_sz)
+		el = data_sz;
+
+	for (i = hl; i < el; ++i) {
+		if (!EEP_READ(data_start + i, &buf[i])) {
+			fprintf(stderr, "Unable to read EEPROM checksummed area\n");
+			return false;
+		}
+	}
+	res->csum = eep_calc_csum(buf, el) == 0xffff;
+
+	return true;
+}
@@ -122,4 +122,21 @@ void ar5416_dump_ctl(const uint8_t *index,
 
 uint16_t eep_calc_csum(const uint16_t *buf, size_t len);
 
+/* Common beginning of the AR5416/AR9285/AR9287 base headers */
+struct ar5416_base_eep_hdr_head {
+	uint16_t length;
+	uint16_t checksum;
+	uint16_t version;
+	uint8_t opCapFlags;
+	uint8_t eepMisc;
+	uint16_t regDmn[2];
+	uint8_t macAddr[6];
+} __attribute__ ((packed));
+
+struct atheepmgr;
+struct eep_probe;
+
+bool ar5416_probe(struct atheepmgr *aem, struct eep_probe *res, bool csum,
+		  uint32_t data_start, size_t data_sz);
+
 #endif /* EEP_COMMON_H */
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <signal.h>
+#include <stdarg.h>
+#include <time.h>
+
+#include "atheepmgr.h"
+#include "utils.h"
+
+#define EW_PERIOD_DEF		60	/* Default check period, s */
+#define EW_BUDGET_DEF		16	/* Default sampled words per period */
+
+struct ew_ctx {
+	uint16_t *base;			/* Baseline image */
+	uint16_t *cur;			/* Full re-read buffer */
+	size_t len;			/* Image length, words */
+	size_t cursor;			/* Next rotating sample word */
+	FILE *log;
+	unsigned long nreads;
+	unsigned long nfull;		/* Number of full re-reads */
+	unsigned long nchanged;		/* Number of changed words */
+};
+
+static volatile sig_atomic_t ew_stop;
+
+static void ew_sig_handler(int sig)
+{
+	ew_stop = 1;
+}
+
+static void ew_log(struct ew_ctx *ctx, const char *fmt, ...)
+{
+	char ts[0x20];
+	time_t now = time(NULL);
+	va_list ap;
+
+	strftime(ts, sizeof(ts), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+	fprintf(ctx->log, "%s ", ts);
+	va_start(ap, fmt);
+	vfprintf(ctx->log, fmt, ap);
+	va_end(ap);
+	fflush(ctx->log);
+}
+
+/* Returns 1 on mismatch, 0 on match and -1 on read failure */
+static int ew_sample(struct atheepmgr *aem, struct ew_ctx *ctx, size_t off)
+{
+	uint16_t word;
+
+	if (off >= ctx->len)
+		return 0;
+
+	ctx->nreads++;
+	if (!EEP_READ(off, &word)) {
+		ew_log(ctx, "unable to read EEPROM at 0x%04zx\n", off);
+		return -1;
+	}
+
+	if (word == ctx->base[off])
+		return 0;
+
+	ew_log(ctx, "sample mismatch at 0x%04zx: 0x%04x, expected 0x%04x\n",
+	       off, word, ctx->base[off]);
+
+	return 1;
+}
+
+/* Re-read the whole EEPROM, report changed words and update the baseline */
+static int ew_full_check(struct atheepmgr *aem, struct ew_ctx *ctx)
+{
+	unsigned long nchanged = 0;
+	size_t off;
+
+	ctx->nfull++;
+	for (off = 0; off < ctx->len; ++off) {
+		ctx->nreads++;
+		if (!EEP_READ(off, &ctx->cur[off])) {
+			ew_log(ctx, "unable to read EEPROM at 0x%04zx, full check aborted\n",
+			       off);
+			return -EIO;
+		}
+	}
+
+	for (off = 0; off < ctx->len; ++off) {
+		if (ctx->cur[off] == ctx->base[off])
+			continue;
+		ew_log(ctx, "changed 0x%04zx: 0x%04x -> 0x%04x\n", off,
+		       ctx->base[off], ctx->cur[off]);
+		ctx->base[off] = ctx->cur[off];
+		nchanged++;
+	}
+
+	ew_log(ctx, "full check: %lu word(s) changed\n", nchanged);
+	ctx->nchanged += nchanged;
+
+	return 0;
+}
+
+static void ew_check(struct atheepmgr *aem, struct ew_ctx *ctx,
+		     unsigned long budget)
+{
+	const struct eepmap_area *area;
+	bool mismatch = false;
+	unsigned long i;
+	size_t off;
+
+	/* Integrity critical words (checksum, headers) are checked each time */
+	if (aem->eepmap->prio_areas)
+		for (area = aem->eepmap->prio_areas; area->len; ++area)
+			for (off = area->off; off < area->off + area->len; ++off)
+				mismatch |= ew_sample(aem, ctx, off) != 0;
+
+	for (i = 0; i < budget && i < ctx->len; ++i) {
+		mismatch |= ew_sample(aem, ctx, ctx->cursor) != 0;
+		ctx->cursor = (ctx->cursor + 1) % ctx->len;
+	}
+
+	if (mismatch)
+		ew_full_check(aem, ctx);
+}
+
+int act_eep_watch(struct atheepmgr *aem, int argc, char *argv[])
+{
+	struct ew_ctx __ctx = {0}, *ctx = &__ctx;
+	unsigned long period = EW_PERIOD_DEF, budget = EW_BUDGET_DEF;
+	unsigned long dur = 0, nperiods = 0;
+	const char *logname = NULL;
+	uint64_t start, next;
+	int i, ret = 0;
+
+	for (i = 0; i < argc; ++i) {
+		if (strncmp(argv[i], "log=", 4) == 0) {
+			logname = argv[i] + 4;
+		} else if (!parse_opt_ulong(argv[i], "period", &period) &&
+			   !parse_opt_ulong(argv[i], "budget", &budget) &&
+			   !parse_opt_ulong(argv[i], "time", &dur)) {
+			fprintf(stderr, "Invalid watching option -- %s\n",
+				argv[i]);
+			return -EINVAL;
+		}
+	}
+	if (!period) {
+		fprintf(stderr, "Watching period should be non-zero\n");
+		return -EINVAL;
+	}
+
+	/* Samples are read via the EEPROM ops, which can not reach OTP */
+	if (aem->eep_otp) {
+		fprintf(stderr, "EEPROM data are read from OTP memory, watching is not supported\n");
+		return -EOPNOTSUPP;
+	}
+
+	ctx->len = aem->eep_len;
+	ctx->base = malloc(ctx->len * sizeof(uint16_t));
+	ctx->cur = malloc(ctx->len * sizeof(uint16_t));
+	if (!ctx->len || !ctx->base || !ctx->cur) {
+		fprintf(stderr, "Unable to allocate memory for the EEPROM baseline\n");
+		ret = -ENOMEM;
+		goto exit;
+	}
+	memcpy(ctx->base, aem->eep_buf, ctx->len * sizeof(uint16_t));
+
+	if (logname) {
+		ctx->log = fopen(logname, "a");
+		if (!ctx->log) {
+			fprintf(stderr, "Unable to open log file '%s': %s\n",
+				logname, strerror(errno));
+			ret = -errno;
+			goto exit;
+		}
+	} else {
+		ctx->log = stdout;
+	}
+
+	signal(SIGINT, ew_sig_handler);
+	signal(SIGTERM, ew_sig_handler);
+
+	ew_log(ctx, "watching %zu words, %lu sampled word(s) every %lu s\n",
+	       ctx->len, budget, period);
+
+	start = next = time_mono_ns();
+	while (!ew_stop) {
+		ew_check(aem, ctx, budget);
+		nperiods++;
+
+		if (dur && time_mono_ns() - start >= dur * 1000000000ULL)
+			break;
+		next += period * 1000000000ULL;
+		sleep_until_ns(next);
+	}
+
+	ew_log(ctx, "stopped after %lu period(s): %lu word(s) read, %lu full check(s), %lu change(s)\n",
+	       nperiods, ctx->nreads, ctx->nfull, ctx->nchanged);
+
+	signal(SIGINT, SIG_DFL);
+	signal(SIGTERM, SIG_DFL);
+
+	if (ctx->log != stdout)
+		fclose(ctx->log);
+
+exit:
+	free(ctx->base);
+	free(ctx->cur);
+
+	return ret;
+}
@@ -0,0 +1,417 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+
+#include "atheepmgr.h"
+#include "eep_5211.h"
+#include "eep_5416.h"
+#include "eep_9285.h"
+#include "eep_9287.h"
+#include "eep_9300.h"
+
+struct extract_hit {
+	size_t off;		/* Image offset, bytes */
+	size_t len;		/* Image length, bytes */
+	const struct eepmap *eepmap;
+};
+
+struct extract_ctx {
+	const uint8_t *img;
+	size_t img_len;
+	struct extract_hit *hits;
+	int nhits;
+	int maxhits;
+};
+
+/* Maps which EEPROM starts with the AR5416 magic */
+static const struct {
+	const struct eepmap *eepmap;
+	size_t data_start;	/* Data start location, words */
+	size_t data_sz;		/* Data size, words */
+} extract_5416_maps[] = {
+	{&eepmap_5416, AR5416_DATA_START_LOC, AR5416_DATA_SZ},
+	{&eepmap_9287, AR9287_DATA_START_LOC, AR9287_DATA_SZ},
+	{&eepmap_9285, AR9285_DATA_START_LOC, AR9285_DATA_SZ},
+};
+
+/* Fetch a little-endian word at the specified byte offset */
+static uint16_t img_word(const struct extract_ctx *ctx, size_t off, int swap)
+{
+	uint16_t word = ctx->img[off] | ctx->img[off + 1] << 8;
+
+	return swap ? bswap_16(word) : word;
+}
+
+static uint16_t img_csum(const struct extract_ctx *ctx, size_t off,
+			 size_t len)
+{
+	uint16_t csum = 0;
+
+	/* NB: XOR checksum is invariant to the bytes order */
+	for (; len > 0; --len, off += 2)
+		csum ^= img_word(ctx, off, 0);
+
+	return csum;
+}
+
+static int extract_hit_add(struct extract_ctx *ctx, size_t off, size_t len,
+			   const struct eepmap *eepmap)
+{
+	struct extract_hit *hits;
+
+	if (ctx->nhits == ctx->maxhits) {
+		ctx->maxhits = ctx->maxhits ? ctx->maxhits * 2 : 16;
+		hits = realloc(ctx->hits, ctx->maxhits * sizeof(*hits));
+		if (!hits) {
+			fprintf(stderr, "Unable to allocate memory for scan results\n");
+			return -ENOMEM;
+		}
+		ctx->hits = hits;
+	}
+
+	ctx->hits[ctx->nhits].off = off;
+	ctx->hits[ctx->nhits].len = len;
+	ctx->hits[ctx->nhits].eepmap = eepmap;
+	ctx->nhits++;
+
+	return 0;
+}
+
+/* Check AR5416 family EEPROM, which magic is located at offset */
+static int extract_check_5416(struct extract_ctx *ctx, size_t off)
+{
+	/* NB: magic is stored as 5a a5 byte sequence */
+	int swap = img_word(ctx, off, 0) != 0xa55a;
+	size_t data, len, el;
+	uint16_t ver, misc;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(extract_5416_maps); ++i) {
+		data = off + extract_5416_maps[i].data_start * 2;
+		len = (extract_5416_maps[i].data_start +
+		       extract_5416_maps[i].data_sz) * 2;
+		if (off + len > ctx->img_len)
+			continue;
+
+		/* Detect data endianness as the EEPROM parser do */
+		misc = img_word(ctx, data + 6, swap) >> 8;
+		el = img_word(ctx, data + 0, swap);
+		ver = img_word(ctx, data + 4, swap);
+		if (misc & AR5416_EEPMISC_BIG_ENDIAN) {
+			el = bswap_16(el);
+			ver = bswap_16(ver);
+		}
+		if ((ver >> 12) != AR5416_EEP_VER)
+			continue;
+
+		el /= sizeof(uint16_t);
+		if (el > extract_5416_maps[i].data_sz)
+			el = extract_5416_maps[i].data_sz;
+		if (el < 4 || img_csum(ctx, data, el) != 0xffff)
+			continue;
+
+		return extract_hit_add(ctx, off, len,
+				       extract_5416_maps[i].eepmap);
+	}
+
+	return 0;
+}
+
+/* Check legacy EEPROM, which magic is located at offset */
+static int extract_check_5211(struct extract_ctx *ctx, size_t off)
+{
+	int swap = img_word(ctx, off, 0) != AR5211_EEPROM_MAGIC_VAL;
+	uint16_t endloc_up, endloc_lo;
+	size_t start, len = 0;
+
+	if (off < AR5211_EEP_MAGIC * 2)
+		return 0;
+	start = off - AR5211_EEP_MAGIC * 2;
+	if (start + AR5211_EEP_INFO_BASE * 2 + 4 > ctx->img_len)
+		return 0;
+
+	endloc_up = img_word(ctx, start + AR5211_EEP_ENDLOC_UP * 2, swap);
+	endloc_lo = img_word(ctx, start + AR5211_EEP_ENDLOC_LO * 2, swap);
+	if (endloc_up) {
+		len = ((uint32_t)MS(endloc_up, AR5211_EEP_ENDLOC_LOC) << 16) |
+		      endloc_lo;
+		if (len > AR5211_SIZE_MAX)
+			len = AR5211_SIZE_MAX;
+	}
+	if (!len)
+		len = AR5211_SIZE_DEF;
+	if (len <= AR5211_EEP_INFO_BASE + 1 || start + len * 2 > ctx->img_len)
+		return 0;
+
+	if (img_word(ctx, start + AR5211_EEP_VER * 2, swap) < AR5211_EEP_VER_3_0)
+		return 0;
+
+	if (img_csum(ctx, start + AR5211_EEP_INFO_BASE * 2,
+		     len - AR5211_EEP_INFO_BASE) != 0xffff)
+		return 0;
+
+	return extract_hit_add(ctx, start, len * 2, &eepmap_5211);
+}
+
+/**
+ * Check AR93xx compressed block, which header is located at offset (NB: the
+ * blocks are stored in the reverse order). Returns block length including
+ * header and checksum or zero if there are no valid block.
+ */
+static size_t extract_9300_block(const struct extract_ctx *ctx, size_t off)
+{
+	struct eep_9300_blk_hdr blkh;
+	uint8_t buf[COMP_HDR_LEN + 0x800 + COMP_CKSUM_LEN];
+	int i, len, spot;
+
+	if (off < COMP_HDR_LEN || off >= ctx->img_len)
+		return 0;
+
+	for (i = 0; i < COMP_HDR_LEN; ++i)
+		buf[i] = ctx->img[off - i];
+	if ((buf[0] & buf[1] & buf[2] & buf[3]) == 0xff ||
+	    (buf[0] | buf[1] | buf[2] | buf[3]) == 0x00)
+		return 0;
+
+	ar9300_comp_hdr_unpack(buf, &blkh);
+	if (blkh.comp != _CompressBlock || blkh.len < 2)
+		return 0;
+	if (blkh.ref && !ar9300_eeprom_struct_find_by_id(blkh.ref))
+		return 0;
+
+	len = COMP_HDR_LEN + blkh.len + COMP_CKSUM_LEN;
+	if (len > off + 1)
+		return 0;
+	for (i = COMP_HDR_LEN; i < len; ++i)
+		buf[i] = ctx->img[off - i];
+
+	if (ar9300_comp_cksum(&buf[COMP_HDR_LEN], blkh.len) !=
+	    (buf[len - 2] | buf[len - 1] << 8))
+		return 0;
+
+	/* Validate the restore pairs to filter out a random match */
+	for (i = 0, spot = 0; i + 1 < blkh.len; i += buf[COMP_HDR_LEN + i + 1] + 2) {
+		spot += buf[COMP_HDR_LEN + i];
+		spot += buf[COMP_HDR_LEN + i + 1];
+		if (spot > sizeof(struct ar9300_eeprom))
+			return 0;
+	}
+
+	return len;
+}
+
+static int extract_check_9300(struct extract_ctx *ctx, size_t off)
+{
+	size_t blen, ext = 0, base;
+
+	while ((blen = extract_9300_block(ctx, off - ext)) != 0)
+		ext += blen;
+	if (!ext)
+		return 0;
+
+	/* Select the EEPROM size in a way that the parser will find the blocks */
+	if (off >= AR9300_BASE_ADDR &&
+	    ((off + 1) % (AR9300_BASE_ADDR + 1) == 0 ||
+	     ext > AR9300_BASE_ADDR_512 + 1))
+		base = AR9300_BASE_ADDR;
+	else
+		base = AR9300_BASE_ADDR_512;
+	if (ext > base + 1)
+		return 0;
+
+	return extract_hit_add(ctx, off - base, base + 1, &eepmap_9300);
+}
+
+static int extract_scan(struct extract_ctx *ctx)
+{
+	const uint8_t *p = ctx->img, *end = ctx->img + ctx->img_len;
+	size_t off;
+	int ret;
+
+	/**
+	 * Both magics consist of the 0xa5 and 0x5a bytes, so lookup for the
+	 * 0xa5 byte using memchr(3), which is a vectorized in any sane libc,
+	 * and then check the pair byte.
+	 */
+	while (p < end && (p = memchr(p, 0xa5, end - p)) != NULL) {
+		off = p - ctx->img;
+		if (off % 2 == 0) {
+			if (off + 1 < ctx->img_len && p[1] == 0x5a)
+				goto check;
+		} else if (p[-1] == 0x5a) {
+			off--;
+			goto check;
+		}
+		p++;
+		continue;
+check:
+		ret = extract_check_5416(ctx, off);
+		if (!ret)
+			ret = extract_check_5211(ctx, off);
+		if (ret)
+			return ret;
+		p++;
+	}
+
+	/* AR93xx blocks could be found only at the predefined locations */
+	for (off = AR9300_BASE_ADDR_512; off < ctx->img_len;
+	     off += AR9300_BASE_ADDR_512 + 1) {
+		ret = extract_check_9300(ctx, off);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+static int extract_hit_cmp(const void *a, const void *b)
+{
+	const struct extract_hit *ha = a, *hb = b;
+
+	if (ha->off != hb->off)
+		return ha->off < hb->off ? -1 : 1;
+
+	return ha->len > hb->len ? -1 : ha->len < hb->len;
+}
+
+static const uint8_t *extract_map_image(const char *fname, size_t *len,
+					int *mapped)
+{
+	uint8_t *img;
+	struct stat st;
+	ssize_t res;
+	size_t pos;
+	int fd;
+
+	fd = open(fname, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Unable to open image file '%s': %s\n", fname,
+			strerror(errno));
+		return NULL;
+	}
+
+	if (fstat(fd, &st) != 0 || !st.st_size) {
+		/* Block and MTD devices report zero size */
+		st.st_size = lseek(fd, 0, SEEK_END);
+		lseek(fd, 0, SEEK_SET);
+	}
+	if (st.st_size <= 0) {
+		fprintf(stderr, "Unable to detect image size or image is empty\n");
+		close(fd);
+		return NULL;
+	}
+	*len = st.st_size;
+
+	img = mmap(NULL, *len, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (img != MAP_FAILED) {
+		*mapped = 1;
+		close(fd);
+		return img;
+	}
+
+	/* Some devices (e.g. MTD) do not support mapping, so read them */
+	*mapped = 0;
+	img = malloc(*len);
+	if (!img) {
+		fprintf(stderr, "Unable to allocate memory for the image\n");
+		close(fd);
+		return NULL;
+	}
+	for (pos = 0; pos < *len; pos += res) {
+		res = read(fd, img + pos, *len - pos);
+		if (res <= 0) {
+			fprintf(stderr, "Unable to read image: %s\n",
+				res ? strerror(errno) : "unexpected EOF");
+			free(img);
+			close(fd);
+			return NULL;
+		}
+	}
+	close(fd);
+
+	return img;
+}
+
+int act_eep_extract(struct atheepmgr *aem, int argc, char *argv[])
+{
+	struct extract_ctx __ctx = {0}, *ctx = &__ctx;
+	const char *prefix = argc > 1 ? argv[1] : "eep";
+	const struct extract_hit *hit;
+	char fname[0x100];
+	int i, mapped, ret;
+	FILE *fp;
+
+	if (argc < 1) {
+		fprintf(stderr, "Image file for scanning is not specified, aborting\n");
+		return -EINVAL;
+	}
+
+	ctx->img = extract_map_image(argv[0], &ctx->img_len, &mapped);
+	if (!ctx->img)
+		return -EIO;
+
+	ret = extract_scan(ctx);
+	if (ret)
+		goto exit;
+
+	qsort(ctx->hits, ctx->nhits, sizeof(ctx->hits[0]), extract_hit_cmp);
+
+	for (i = 0, hit = NULL; i < ctx->nhits; ++i) {
+		/* Skip blocks, which are part of the previous hit */
+		if (hit && ctx->hits[i].off + ctx->hits[i].len <=
+			   hit->off + hit->len)
+			continue;
+		hit = &ctx->hits[i];
+
+		snprintf(fname, sizeof(fname), "%s-%08lx-%s.bin", prefix,
+			 (unsigned long)hit->off, hit->eepmap->name);
+		printf("0x%08lx: %-4s EEPROM, %5lu bytes -> %s\n",
+		       (unsigned long)hit->off, hit->eepmap->name,
+		       (unsigned long)hit->len, fname);
+
+		fp = fopen(fname, "wb");
+		if (!fp) {
+			fprintf(stderr, "Unable to open output file for writing: %s\n",
+				strerror(errno));
+			ret = -errno;
+			goto exit;
+		}
+		if (fwrite(ctx->img + hit->off, 1, hit->len, fp) != hit->len) {
+			fprintf(stderr, "Unable to save EEPROM contents: %s\n",
+				strerror(errno));
+			ret = -EIO;
+		}
+		fclose(fp);
+		if (ret)
+			goto exit;
+	}
+
+	if (!ctx->nhits)
+		printf("No EEPROM data found\n");
+
+exit:
+	free(ctx->hits);
+	if (mapped)
+		munmap((void *)ctx->img, ctx->img_len);
+	else
+		free((void *)ctx->img);
+
+	return ret;
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <signal.h>
+
+#include "atheepmgr.h"
+#include "utils.h"
+
+#define GW_RATE_DEF		10000	/* Default sampling rate, Hz */
+#define GW_RING_SZ		4096	/* Events ring size, power of 2 */
+#define GW_FLUSH_INTVL		100000000ULL	/* Events print interval, ns */
+
+struct gw_event {
+	uint64_t ts;			/* Timestamp, ns since start */
+	uint32_t val;			/* Input lines state */
+};
+
+struct gw_ctx {
+	struct gw_event ring[GW_RING_SZ];
+	unsigned head;			/* Next event to write */
+	unsigned tail;			/* Next event to print */
+	unsigned long nlost;		/* Events lost due to the ring overrun */
+	uint32_t mask;
+	uint32_t last;			/* Last printed state */
+};
+
+static volatile sig_atomic_t gw_stop;
+
+static void gw_sig_handler(int sig)
+{
+	gw_stop = 1;
+}
+
+static void gw_ring_flush(struct atheepmgr *aem, struct gw_ctx *ctx)
+{
+	const struct gw_event *ev;
+	uint32_t diff;
+	unsigned i;
+
+	for (; ctx->tail != ctx->head; ctx->tail++) {
+		ev = &ctx->ring[ctx->tail % GW_RING_SZ];
+		diff = (ev->val ^ ctx->last) & ctx->mask;
+		for (i = 0; i < aem->gpio_num; ++i) {
+			if (!(diff & BIT(i)))
+				continue;
+			printf("%6llu.%06llu  GPIO #%-2u %s\n",
+			       (unsigned long long)(ev->ts / 1000000000ULL),
+			       (unsigned long long)(ev->ts % 1000000000ULL) / 1000,
+			       i, ev->val & BIT(i) ? "rise" : "fall");
+		}
+		ctx->last = ev->val;
+	}
+	fflush(stdout);
+}
+
+int act_gpio_watch(struct atheepmgr *aem, int argc, char *argv[])
+{
+	struct gw_ctx *ctx;
+	unsigned long rate = GW_RATE_DEF, dur = 0, mask = ~0UL;
+	uint64_t start, now, next, period, flush, nsamples = 0;
+	uint32_t val, prev;
+	int i;
+
+	if (!aem->gpio) {
+		fprintf(stderr, "GPIO control is not supported for this chip, aborting\n");
+		return -EOPNOTSUPP;
+	}
+
+	for (i = 0; i < argc; ++i) {
+		if (!parse_opt_ulong(argv[i], "rate", &rate) &&
+		    !parse_opt_ulong(argv[i], "time", &dur) &&
+		    !parse_opt_ulong(argv[i], "mask", &mask)) {
+			fprintf(stderr, "Invalid watching option -- %s\n",
+				argv[i]);
+			return -EINVAL;
+		}
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx) {
+		fprintf(stderr, "Unable to allocate memory for GPIO events\n");
+		return -ENOMEM;
+	}
+	ctx->mask = mask & (BIT(aem->gpio_num) - 1);
+
+	signal(SIGINT, gw_sig_handler);
+	signal(SIGTERM, gw_sig_handler);
+
+	period = rate ? 1000000000ULL / rate : 0;
+	prev = ctx->last = aem->gpio->input_get(aem);
+	printf("Watching GPIO inputs (initial state 0x%05x) at %lu Hz%s, press Ctrl-C to stop\n",
+	       prev, rate, rate ? "" : " (max)");
+	fflush(stdout);
+
+	start = next = time_mono_ns();
+	flush = start + GW_FLUSH_INTVL;
+	while (!gw_stop) {
+		val = aem->gpio->input_get(aem);
+		now = time_mono_ns();
+		nsamples++;
+
+		if ((val ^ prev) & ctx->mask) {
+			if (ctx->head - ctx->tail == GW_RING_SZ) {
+				ctx->nlost++;
+			} else {
+				ctx->ring[ctx->head % GW_RING_SZ].ts = now - start;
+				ctx->ring[ctx->head % GW_RING_SZ].val = val;
+				ctx->head++;
+			}
+			prev = val;
+		}
+
+		/* Print events out of the sampling path */
+		if (now >= flush) {
+			gw_ring_flush(aem, ctx);
+			flush = now + GW_FLUSH_INTVL;
+			if (dur && now - start >= dur * 1000000000ULL)
+				break;
+		}
+
+		if (!period)
+			continue;
+		next += period;
+		if (next > now)
+			sleep_until_ns(next);
+		else if (now - next > 1000000000ULL)
+			next = now;	/* Do not try to catch up forever */
+	}
+
+	gw_ring_flush(aem, ctx);
+
+	now = time_mono_ns();
+	printf("%llu samples in %.3f s (%.0f Hz achieved)",
+	       (unsigned long long)nsamples, (now - start) / 1e9,
+	       nsamples * 1e9 / (now - start ? now - start : 1));
+	if (ctx->nlost)
+		printf(", %lu events lost", ctx->nlost);
+	printf("\n");
+
+	signal(SIGINT, SIG_DFL);
+	signal(SIGTERM, SIG_DFL);
+	free(ctx);
+
+	return 0;
+}
@@ -17,6 +17,8 @@
 
 #include "atheepmgr.h"
 #include "hw.h"
+#include "utils.h"
+#include "trace.h"
 
 static struct {
 	uint32_t version;
@@ -110,72 +112,155 @@ static void hw_read_revisions(struct atheepmgr *aem)
 	}
 }
 
-bool hw_wait(struct atheepmgr *aem, uint32_t reg, uint32_t mask,
-	     uint32_t val, uint32_t timeout)
+/**
+ * Registers shadow cache. Only registers that are explicitly declared as
+ * non-volatile (i.e. changed only by ourself, like GPIO configuration) are
+ * cached, so RMWs of them are served from the shadow copy and writes that
+ * do not change anything are skipped. Status and input registers should
+ * never be declared here.
+ */
+void hw_regcache_add(struct atheepmgr *aem, uint32_t reg)
 {
-	int i;
+	struct regcache_ent *ent;
+	unsigned i;
 
-	for (i = 0; i < (timeout / AH_TIME_QUANTUM); i++) {
-		if ((REG_READ(reg) & mask) == val)
-			return true;
+	for (i = 0; i < aem->regcache_num; ++i)
+		if (aem->regcache[i].reg == reg)
+			return;
 
-		usleep(AH_TIME_QUANTUM);
+	if (aem->regcache_num == ARRAY_SIZE(aem->regcache))
+		return;		/* Just access such register directly */
+
+	ent = &aem->regcache[aem->regcache_num++];
+	ent->reg = reg;
+	ent->valid = false;
+}
+
+static struct regcache_ent *hw_regcache_find(struct atheepmgr *aem,
+					     uint32_t reg)
+{
+	unsigned i;
+
+	for (i = 0; i < aem->regcache_num; ++i)
+		if (aem->regcache[i].reg == reg)
+			return &aem->regcache[i];
+
+	return NULL;
+}
+
+uint32_t hw_reg_read(struct atheepmgr *aem, uint32_t reg)
+{
+	struct regcache_ent *ent = hw_regcache_find(aem, reg);
+
+	if (!ent)
+		return aem->con->reg_read(aem, reg);
+
+	if (!ent->valid) {
+		ent->val = aem->con->reg_read(aem, reg);
+		ent->valid = true;
 	}
 
-	return false;
+	return ent->val;
 }
 
-static int hw_gpio_input_get_ar9xxx(struct atheepmgr *aem, unsigned gpio)
+void hw_reg_write(struct atheepmgr *aem, uint32_t reg, uint32_t val)
 {
-	uint32_t regval = REG_READ(AR9XXX_GPIO_IN_OUT);
+	struct regcache_ent *ent = hw_regcache_find(aem, reg);
 
-	if (gpio >= aem->gpio_num)
-		return 0;
+	if (ent) {
+		if (ent->valid && ent->val == val)
+			return;
+		ent->val = val;
+		ent->valid = true;
+	}
+
+	aem->con->reg_write(aem, reg, val);
+}
+
+void hw_reg_rmw(struct atheepmgr *aem, uint32_t reg, uint32_t set,
+		uint32_t clr)
+{
+	struct regcache_ent *ent = hw_regcache_find(aem, reg);
 
-	if (AR_SREV_9300_20_OR_LATER(aem))
-		regval = MS(regval, AR9300_GPIO_IN_VAL);
-	else if (AR_SREV_9287_11_OR_LATER(aem))
-		regval = MS(regval, AR9287_GPIO_IN_VAL);
-	else if (AR_SREV_9285_12_OR_LATER(aem))
-		regval = MS(regval, AR9285_GPIO_IN_VAL);
-	else if (AR_SREV_9280_20_OR_LATER(aem))
-		regval = MS(regval, AR9280_GPIO_IN_VAL);
-	else
-		regval = MS(regval, AR5416_GPIO_IN_VAL);
+	if (!ent) {
+		aem->con->reg_rmw(aem, reg, set, clr);
+		return;
+	}
 
-	return !!(regval & BIT(gpio));
+	hw_reg_write(aem, reg, (hw_reg_read(aem, reg) & ~clr) | set);
 }
 
-static int hw_gpio_output_get_ar9xxx(struct atheepmgr *aem, unsigned gpio)
+/**
+ * Pace the EEPROM (OTP) words reading to the configured rate, so the bulk
+ * reading does not saturate the bus, which is shared with the driver. Reads
+ * are spread evenly, a missed slot is not compensated with a burst.
+ */
+void hw_read_pace(struct atheepmgr *aem)
 {
-	if (gpio >= aem->gpio_num)
-		return 0;
+	uint64_t now;
+
+	if (!aem->rd_rate || !(aem->con->caps & CON_CAP_HW))
+		return;
 
-	return !!(REG_READ(AR9XXX_GPIO_IN_OUT) & BIT(gpio));
+	now = time_mono_ns();
+	if (!aem->rd_num) {
+		aem->rd_start = aem->rd_next = now;
+	} else {
+		aem->rd_next += 1000000000ULL / aem->rd_rate;
+		if (aem->rd_next > now)
+			sleep_until_ns(aem->rd_next);
+		else
+			aem->rd_next = now;
+	}
+	aem->rd_num++;
 }
 
-static void hw_gpio_output_set_ar9xxx(struct atheepmgr *aem, unsigned gpio,
-				      int val)
+void hw_read_stat(struct atheepmgr *aem)
 {
-	REG_RMW(AR9XXX_GPIO_IN_OUT, !!val << gpio, 1 << gpio);
+	uint64_t dur;
+
+	if (!aem->rd_num)
+		return;
+
+	dur = time_mono_ns() - aem->rd_start;
+	fprintf(stderr, "Paced read: %lu words in %.3f s (%.0f words/s, limit %lu words/s)\n",
+		aem->rd_num, dur / 1e9, aem->rd_num * 1e9 / (dur ? dur : 1),
+		aem->rd_rate);
 }
 
-static int hw_gpio_out_mux_get_ar9xxx(struct atheepmgr *aem, unsigned gpio)
+bool hw_wait(struct atheepmgr *aem, uint32_t reg, uint32_t mask,
+	     uint32_t val, uint32_t timeout)
 {
-	uint32_t reg;
-	unsigned sh = (gpio % 6) * 5;
+	int i;
 
-	if (gpio >= aem->gpio_num)
-		return 0;
+	TRACE_PROBE3(hw_wait_enter, reg, mask, val);
+
+	for (i = 0; i < (timeout / AH_TIME_QUANTUM); i++) {
+		if ((REG_READ(reg) & mask) == val) {
+			TRACE_PROBE2(hw_wait_exit, reg, i);
+			return true;
+		}
+
+		usleep(AH_TIME_QUANTUM);
+	}
+
+	TRACE_PROBE2(hw_wait_exit, reg, -1);	/* Timeout */
+
+	return false;
+}
+
+static uint32_t hw_gpio_input_get_ar9xxx(struct atheepmgr *aem)
+{
+	const struct hw_chip *chip = aem->chip;
 
-	if (gpio > 11)
-		reg = AR9XXX_GPIO_OUTPUT_MUX3;
-	else if (gpio > 5)
-		reg = AR9XXX_GPIO_OUTPUT_MUX2;
-	else
-		reg = AR9XXX_GPIO_OUTPUT_MUX1;
+	return (REG_READ(chip->gpio_in_out) & chip->gpio_in_val) >>
+	       chip->gpio_in_val_s;
+}
 
-	return (REG_READ(reg) >> sh) & AR9XXX_GPIO_OUTPUT_MUX_MASK;
+static void hw_gpio_output_set_ar9xxx(struct atheepmgr *aem, unsigned gpio,
+				      int val)
+{
+	REG_RMW(aem->chip->gpio_in_out, !!val << gpio, 1 << gpio);
 }
 
 static void hw_gpio_out_mux_set_ar9xxx(struct atheepmgr *aem, unsigned gpio,
@@ -187,15 +272,10 @@ static void hw_gpio_out_mux_set_ar9xxx(struct atheepmgr *aem, unsigned gpio,
 	if (gpio >= aem->gpio_num)
 		return;
 
-	if (gpio > 11)
-		reg = AR9XXX_GPIO_OUTPUT_MUX3;
-	else if (gpio > 5)
-		reg = AR9XXX_GPIO_OUTPUT_MUX2;
-	else
-		reg = AR9XXX_GPIO_OUTPUT_MUX1;
+	/* MUX1..MUX3 registers are consecutive, 6 lines per register */
+	reg = aem->chip->gpio_out_mux1 + (gpio / 6) * 4;
 
-	if (AR_SREV_9280_20_OR_LATER(aem) ||
-	    reg != AR9XXX_GPIO_OUTPUT_MUX1) {
+	if (!aem->chip->gpio_out_mux1_legacy || gpio > 5) {
 		REG_RMW(reg, type << sh, AR9XXX_GPIO_OUTPUT_MUX_MASK << sh);
 	} else {
 		tmp = REG_READ(reg);
@@ -206,11 +286,8 @@ static void hw_gpio_out_mux_set_ar9xxx(struct atheepmgr *aem, unsigned gpio,
 	}
 }
 
-static const char *hw_gpio_out_mux_get_str_ar9xxx(struct atheepmgr *aem,
-						  unsigned gpio)
+static const char *hw_gpio_out_mux_str_ar9xxx(int type)
 {
-	int type = hw_gpio_out_mux_get_ar9xxx(aem, gpio);
-
 	switch (type) {
 	case AR9XXX_GPIO_OUTPUT_MUX_OUTPUT:
 		return "Out";
@@ -227,16 +304,6 @@ static const char *hw_gpio_out_mux_get_str_ar9xxx(struct atheepmgr *aem,
 	return "Unk";
 }
 
-static int hw_gpio_dir_get_ar9xxx(struct atheepmgr *aem, unsigned gpio)
-{
-	unsigned sh = gpio * 2;
-
-	if (gpio >= aem->gpio_num)
-		return -1;
-
-	return (REG_READ(AR9XXX_GPIO_OE_OUT) >> sh) & AR9XXX_GPIO_OE_OUT_DRV;
-}
-
 static void hw_gpio_dir_set_out_ar9xxx(struct atheepmgr *aem, unsigned gpio)
 {
 	unsigned sh = gpio * 2;
@@ -246,16 +313,13 @@ static void hw_gpio_dir_set_out_ar9xxx(struct atheepmgr *aem, unsigned gpio)
 
 	hw_gpio_out_mux_set_ar9xxx(aem, gpio, AR9XXX_GPIO_OUTPUT_MUX_OUTPUT);
 
-	REG_RMW(AR9XXX_GPIO_OE_OUT,
+	REG_RMW(aem->chip->gpio_oe_out,
 		AR9XXX_GPIO_OE_OUT_DRV_ALL << sh,
 		AR9XXX_GPIO_OE_OUT_DRV << sh);
 }
 
-static const char *hw_gpio_dir_get_str_ar9xxx(struct atheepmgr *aem,
-					      unsigned gpio)
+static const char *hw_gpio_dir_str_ar9xxx(int dir)
 {
-	int dir = hw_gpio_dir_get_ar9xxx(aem, gpio);
-
 	switch (dir) {
 	case AR9XXX_GPIO_OE_OUT_DRV_NO:
 		return "In";
@@ -270,13 +334,35 @@ static const char *hw_gpio_dir_get_str_ar9xxx(struct atheepmgr *aem,
 	return "Unk";
 }
 
+static void hw_gpio_state_get_ar9xxx(struct atheepmgr *aem,
+				     struct gpio_state *st)
+{
+	const struct hw_chip *chip = aem->chip;
+	uint32_t inout = REG_READ(chip->gpio_in_out);
+	uint32_t oe = REG_READ(chip->gpio_oe_out);
+	uint32_t mux[3];
+	unsigned i;
+
+	mux[0] = REG_READ(chip->gpio_out_mux1);
+	mux[1] = REG_READ(chip->gpio_out_mux1 + 4);
+	mux[2] = aem->gpio_num > 12 ? REG_READ(chip->gpio_out_mux1 + 8) : 0;
+
+	st->in = (inout & chip->gpio_in_val) >> chip->gpio_in_val_s;
+	st->out = inout & (BIT(aem->gpio_num) - 1);
+	for (i = 0; i < aem->gpio_num; ++i) {
+		st->dir[i] = hw_gpio_dir_str_ar9xxx((oe >> (i * 2)) &
+						    AR9XXX_GPIO_OE_OUT_DRV);
+		st->out_mux[i] = hw_gpio_out_mux_str_ar9xxx((mux[i / 6] >>
+							     ((i % 6) * 5)) &
+							    AR9XXX_GPIO_OUTPUT_MUX_MASK);
+	}
+}
+
 static const struct gpio_ops gpio_ops_ar9xxx = {
 	.input_get = hw_gpio_input_get_ar9xxx,
-	.output_get = hw_gpio_output_get_ar9xxx,
+	.state_get = hw_gpio_state_get_ar9xxx,
 	.output_set = hw_gpio_output_set_ar9xxx,
 	.dir_set_out = hw_gpio_dir_set_out_ar9xxx,
-	.dir_get_str = hw_gpio_dir_get_str_ar9xxx,
-	.out_mux_get_str = hw_gpio_out_mux_get_str_ar9xxx,
 };
 
 static bool hw_eeprom_read_9xxx(struct atheepmgr *aem, uint32_t off,
@@ -286,13 +372,14 @@ static bool hw_eeprom_read_9xxx(struct atheepmgr *aem, uint32_t off,
 			AR_EEPROM_STATUS_DATA_PROT_ACCESS
 #define WAIT_TIME	AH_WAIT_TIMEOUT
 
+	const uint32_t reg = aem->chip->eep_status_data;
+
 	(void)REG_READ(AR5416_EEPROM_OFFSET + (off << AR5416_EEPROM_S));
 
-	if (!hw_wait(aem, AR_EEPROM_STATUS_DATA, WAIT_MASK, 0, WAIT_TIME))
+	if (!hw_wait(aem, reg, WAIT_MASK, 0, WAIT_TIME))
 		return false;
 
-	*data = MS(REG_READ(AR_EEPROM_STATUS_DATA),
-		   AR_EEPROM_STATUS_DATA_VAL);
+	*data = MS(REG_READ(reg), AR_EEPROM_STATUS_DATA_VAL);
 
 	return true;
 
@@ -310,7 +397,7 @@ static bool hw_eeprom_write_9xxx(struct atheepmgr *aem, uint32_t off,
 #define WAIT_TIME	AH_WAIT_TIMEOUT
 
 	REG_WRITE(AR5416_EEPROM_OFFSET + (off << AR5416_EEPROM_S), data);
-	if (!hw_wait(aem, AR_EEPROM_STATUS_DATA, WAIT_MASK, 0, WAIT_TIME))
+	if (!hw_wait(aem, aem->chip->eep_status_data, WAIT_MASK, 0, WAIT_TIME))
 		return false;
 
 	return true;
@@ -319,20 +406,9 @@ static bool hw_eeprom_write_9xxx(struct atheepmgr *aem, uint32_t off,
 #undef WAIT_MASK
 }
 
-static int hw_gpio_input_get_ar5xxx(struct atheepmgr *aem, unsigned gpio)
-{
-	if (gpio >= aem->gpio_num)
-		return 0;
-
-	return !!(REG_READ(AR5XXX_GPIO_IN) & BIT(gpio));
-}
-
-static int hw_gpio_output_get_ar5xxx(struct atheepmgr *aem, unsigned gpio)
+static uint32_t hw_gpio_input_get_ar5xxx(struct atheepmgr *aem)
 {
-	if (gpio >= aem->gpio_num)
-		return 0;
-
-	return !!(REG_READ(AR5XXX_GPIO_OUT) & BIT(gpio));
+	return REG_READ(AR5XXX_GPIO_IN) & (BIT(aem->gpio_num) - 1);
 }
 
 static void hw_gpio_output_set_ar5xxx(struct atheepmgr *aem, unsigned gpio,
@@ -341,16 +417,6 @@ static void hw_gpio_output_set_ar5xxx(struct atheepmgr *aem, unsigned gpio,
 	REG_RMW(AR5XXX_GPIO_OUT, !!val << gpio, 1 << gpio);
 }
 
-static int hw_gpio_dir_get_ar5xxx(struct atheepmgr *aem, unsigned gpio)
-{
-	unsigned sh = gpio * 2;
-
-	if (gpio >= aem->gpio_num)
-		return 0;
-
-	return (REG_READ(AR5XXX_GPIO_CTRL) >> sh) & AR5XXX_GPIO_CTRL_DRV;
-}
-
 static void hw_gpio_dir_set_out_ar5xxx(struct atheepmgr *aem, unsigned gpio)
 {
 	unsigned sh = gpio * 2;
@@ -363,11 +429,8 @@ static void hw_gpio_dir_set_out_ar5xxx(struct atheepmgr *aem, unsigned gpio)
 		AR5XXX_GPIO_CTRL_DRV << sh);
 }
 
-static const char *hw_gpio_dir_get_str_ar5xxx(struct atheepmgr *aem,
-					      unsigned gpio)
+static const char *hw_gpio_dir_str_ar5xxx(int dir)
 {
-	int dir = hw_gpio_dir_get_ar5xxx(aem, gpio);
-
 	switch (dir) {
 	case AR5XXX_GPIO_CTRL_DRV_NO:
 		return "In";
@@ -382,12 +445,26 @@ static const char *hw_gpio_dir_get_str_ar5xxx(struct atheepmgr *aem,
 	return "Unk";
 }
 
+static void hw_gpio_state_get_ar5xxx(struct atheepmgr *aem,
+				     struct gpio_state *st)
+{
+	uint32_t ctrl = REG_READ(AR5XXX_GPIO_CTRL);
+	unsigned i;
+
+	st->in = hw_gpio_input_get_ar5xxx(aem);
+	st->out = REG_READ(AR5XXX_GPIO_OUT) & (BIT(aem->gpio_num) - 1);
+	for (i = 0; i < aem->gpio_num; ++i) {
+		st->dir[i] = hw_gpio_dir_str_ar5xxx((ctrl >> (i * 2)) &
+						    AR5XXX_GPIO_CTRL_DRV);
+		st->out_mux[i] = NULL;
+	}
+}
+
 static const struct gpio_ops gpio_ops_ar5xxx = {
 	.input_get = hw_gpio_input_get_ar5xxx,
-	.output_get = hw_gpio_output_get_ar5xxx,
+	.state_get = hw_gpio_state_get_ar5xxx,
 	.output_set = hw_gpio_output_set_ar5xxx,
 	.dir_set_out = hw_gpio_dir_set_out_ar5xxx,
-	.dir_get_str = hw_gpio_dir_get_str_ar5xxx,
 };
 
 static bool hw_eeprom_read_5211(struct atheepmgr *aem, uint32_t off, uint16_t *data)
@@ -477,14 +554,11 @@ void hw_eeprom_set_ops(struct atheepmgr *aem)
 		if (aem->verbose)
 			printf("EEPROM access ops: use connector's ops\n");
 		aem->eep = aem->con->eep;
-	} else if (AR_SREV_5416_OR_LATER(aem)) {
+	} else if (aem->chip) {
 		if (aem->verbose)
-			printf("EEPROM access ops: use AR9xxx ops\n");
-		aem->eep = &hw_eep_9xxx;
-	} else if (AR_SREV_5211_OR_LATER(aem)) {
-		if (aem->verbose)
-			printf("EEPROM access ops: use AR5211 ops\n");
-		aem->eep = &hw_eep_5211;
+			printf("EEPROM access ops: use %s ops\n",
+			       aem->chip->name);
+		aem->eep = aem->chip->eep;
 	} else {
 		printf("Unable to select EEPROM access ops due to unknown chip\n");
 	}
@@ -492,22 +566,40 @@ void hw_eeprom_set_ops(struct atheepmgr *aem)
 
 bool hw_eeprom_read(struct atheepmgr *aem, uint32_t off, uint16_t *data)
 {
-	if (!aem->eep || !aem->eep->read(aem, off, data))
+	TRACE_PROBE1(eep_read_enter, off);
+	if (aem->trace_fp)
+		trace_eep_read(aem, off);
+
+	hw_read_pace(aem);
+
+	if (!aem->eep || !aem->eep->read(aem, off, data)) {
+		TRACE_PROBE2(eep_read_exit, off, -1);
 		return false;
+	}
+
+	aem->eep_nreads++;
 
 	if (aem->eep_io_swap)
 		*data = bswap_16(*data);
 
+	TRACE_PROBE2(eep_read_exit, off, *data);
+
 	return true;
 }
 
 bool hw_eeprom_write(struct atheepmgr *aem, uint32_t off, uint16_t data)
 {
+	TRACE_PROBE2(eep_write_enter, off, data);
+
 	if (aem->eep_io_swap)
 		data = bswap_16(data);
 
-	if (!aem->eep || !aem->eep->write(aem, off, data))
+	if (!aem->eep || !aem->eep->write(aem, off, data)) {
+		TRACE_PROBE2(eep_write_exit, off, 0);
 		return false;
+	}
+
+	TRACE_PROBE2(eep_write_exit, off, 1);
 
 	return true;
 }
@@ -518,36 +610,163 @@ void hw_eeprom_lock(struct atheepmgr *aem, int lock)
 		aem->eep->lock(aem, lock);
 }
 
+/* Non-volatile GPIO configuration registers, which could be cached */
+static const uint32_t hw_nv_regs_ar9340[] = {
+	AR9340_GPIO_OE_OUT, AR9340_GPIO_OUTPUT_MUX1,
+	AR9340_GPIO_OUTPUT_MUX1 + 4, AR9340_GPIO_OUTPUT_MUX1 + 8, 0
+};
+
+static const uint32_t hw_nv_regs_ar9300[] = {
+	AR9300_GPIO_OE_OUT, AR9300_GPIO_OUTPUT_MUX1,
+	AR9300_GPIO_OUTPUT_MUX1 + 4, AR9300_GPIO_OUTPUT_MUX1 + 8, 0
+};
+
+static const uint32_t hw_nv_regs_ar5416[] = {
+	AR5416_GPIO_OE_OUT, AR5416_GPIO_OUTPUT_MUX1,
+	AR5416_GPIO_OUTPUT_MUX1 + 4, AR5416_GPIO_OUTPUT_MUX1 + 8, 0
+};
+
+static const uint32_t hw_nv_regs_ar5xxx[] = {
+	AR5XXX_GPIO_CTRL, AR5XXX_GPIO_OUT, 0
+};
+
+/**
+ * Chips registers layout & capabilities, the first matching entry is used,
+ * so entries should be ordered from the newest chip to the oldest one.
+ */
+static const struct hw_chip hw_chips[] = {
+	{
+		.name = "AR9340",
+		.mac_version = AR_SREV_VERSION_9340,
+		.exact = true,
+		.gpio_num = 17,
+		.eep_wp_gpio_num = 3,
+		.gpio = &gpio_ops_ar9xxx,
+		.eep = &hw_eep_9xxx,
+		.nv_regs = hw_nv_regs_ar9340,
+		.eep_status_data = AR9340_EEPROM_STATUS_DATA,
+		.gpio_in_out = AR9340_GPIO_IN_OUT,
+		.gpio_oe_out = AR9340_GPIO_OE_OUT,
+		.gpio_out_mux1 = AR9340_GPIO_OUTPUT_MUX1,
+		.gpio_in_val = AR9300_GPIO_IN_VAL,
+		.gpio_in_val_s = AR9300_GPIO_IN_VAL_S,
+	}, {
+		.name = "AR9300",
+		.mac_version = AR_SREV_VERSION_9300,
+		.gpio_num = 17,
+		.eep_wp_gpio_num = 3,
+		.gpio = &gpio_ops_ar9xxx,
+		.eep = &hw_eep_9xxx,
+		.nv_regs = hw_nv_regs_ar9300,
+		.eep_status_data = AR9300_EEPROM_STATUS_DATA,
+		.gpio_in_out = AR5416_GPIO_IN_OUT,
+		.gpio_oe_out = AR9300_GPIO_OE_OUT,
+		.gpio_out_mux1 = AR9300_GPIO_OUTPUT_MUX1,
+		.gpio_in_val = AR9300_GPIO_IN_VAL,
+		.gpio_in_val_s = AR9300_GPIO_IN_VAL_S,
+	}, {
+		.name = "AR9287",
+		.mac_version = AR_SREV_VERSION_9287,
+		.gpio_num = 11,
+		.eep_wp_gpio_num = 3,
+		.gpio = &gpio_ops_ar9xxx,
+		.eep = &hw_eep_9xxx,
+		.nv_regs = hw_nv_regs_ar5416,
+		.eep_status_data = AR5416_EEPROM_STATUS_DATA,
+		.gpio_in_out = AR5416_GPIO_IN_OUT,
+		.gpio_oe_out = AR5416_GPIO_OE_OUT,
+		.gpio_out_mux1 = AR5416_GPIO_OUTPUT_MUX1,
+		.gpio_in_val = AR9287_GPIO_IN_VAL,
+		.gpio_in_val_s = AR9287_GPIO_IN_VAL_S,
+	}, {
+		.name = "AR9285",
+		.mac_version = AR_SREV_VERSION_9285,
+		.gpio_num = 12,
+		.eep_wp_gpio_num = 3,
+		.gpio = &gpio_ops_ar9xxx,
+		.eep = &hw_eep_9xxx,
+		.nv_regs = hw_nv_regs_ar5416,
+		.eep_status_data = AR5416_EEPROM_STATUS_DATA,
+		.gpio_in_out = AR5416_GPIO_IN_OUT,
+		.gpio_oe_out = AR5416_GPIO_OE_OUT,
+		.gpio_out_mux1 = AR5416_GPIO_OUTPUT_MUX1,
+		.gpio_in_val = AR9285_GPIO_IN_VAL,
+		.gpio_in_val_s = AR9285_GPIO_IN_VAL_S,
+	}, {
+		.name = "AR9280",
+		.mac_version = AR_SREV_VERSION_9280,
+		.gpio_num = 10,
+		.eep_wp_gpio_num = 3,
+		.gpio = &gpio_ops_ar9xxx,
+		.eep = &hw_eep_9xxx,
+		.nv_regs = hw_nv_regs_ar5416,
+		.eep_status_data = AR5416_EEPROM_STATUS_DATA,
+		.gpio_in_out = AR5416_GPIO_IN_OUT,
+		.gpio_oe_out = AR5416_GPIO_OE_OUT,
+		.gpio_out_mux1 = AR5416_GPIO_OUTPUT_MUX1,
+		.gpio_in_val = AR9280_GPIO_IN_VAL,
+		.gpio_in_val_s = AR9280_GPIO_IN_VAL_S,
+	}, {
+		.name = "AR5416",
+		.mac_version = AR_SREV_VERSION_5418,
+		.gpio_num = 14,
+		.eep_wp_gpio_num = 3,
+		.gpio = &gpio_ops_ar9xxx,
+		.eep = &hw_eep_9xxx,
+		.nv_regs = hw_nv_regs_ar5416,
+		.eep_status_data = AR5416_EEPROM_STATUS_DATA,
+		.gpio_in_out = AR5416_GPIO_IN_OUT,
+		.gpio_oe_out = AR5416_GPIO_OE_OUT,
+		.gpio_out_mux1 = AR5416_GPIO_OUTPUT_MUX1,
+		.gpio_in_val = AR5416_GPIO_IN_VAL,
+		.gpio_in_val_s = AR5416_GPIO_IN_VAL_S,
+		.gpio_out_mux1_legacy = true,
+	}, {
+		.name = "AR5211",
+		.mac_version = AR_SREV_VERSION_5211,
+		.gpio_num = 6,
+		.eep_wp_gpio_num = 4,
+		.gpio = &gpio_ops_ar5xxx,
+		.eep = &hw_eep_5211,
+		.nv_regs = hw_nv_regs_ar5xxx,
+	},
+};
+
+static const struct hw_chip *hw_chip_find(uint32_t mac_version)
+{
+	const struct hw_chip *chip;
+
+	for (chip = hw_chips; chip < hw_chips + ARRAY_SIZE(hw_chips); ++chip) {
+		if (chip->exact ? mac_version == chip->mac_version :
+				  mac_version >= chip->mac_version)
+			return chip;
+	}
+
+	return NULL;
+}
+
 int hw_init(struct atheepmgr *aem)
 {
+	const uint32_t *reg;
+
+	TRACE_PROBE(hw_init_enter);
+
 	hw_read_revisions(aem);
 
-	if (AR_SREV_5416_OR_LATER(aem)) {
-		aem->gpio = &gpio_ops_ar9xxx;
-
-		if (AR_SREV_9300_20_OR_LATER(aem))
-			aem->gpio_num = 17;
-		else if (AR_SREV_9287_11_OR_LATER(aem))
-			aem->gpio_num = 11;
-		else if (AR_SREV_9285_12_OR_LATER(aem))
-			aem->gpio_num = 12;
-		else if (AR_SREV_9280_20_OR_LATER(aem))
-			aem->gpio_num = 10;
-		else
-			aem->gpio_num = 14;
-	} else if (AR_SREV_5211_OR_LATER(aem)) {
-		aem->gpio = &gpio_ops_ar5xxx;
-		aem->gpio_num = 6;
+	aem->chip = hw_chip_find(aem->macVersion);
+	if (aem->chip) {
+		aem->gpio = aem->chip->gpio;
+		aem->gpio_num = aem->chip->gpio_num;
+		if (aem->regcache_on)
+			for (reg = aem->chip->nv_regs; *reg; ++reg)
+				hw_regcache_add(aem, *reg);
 	} else {
 		fprintf(stderr, "Unable to configure chip GPIO support\n");
 	}
 
 	if (aem->eep_wp_gpio_num == EEP_WP_GPIO_AUTO) {
-		if (AR_SREV_5416_OR_LATER(aem)) {
-			aem->eep_wp_gpio_num = 3;
-			aem->eep_wp_gpio_pol = 0;
-		} else if (AR_SREV_5211_OR_LATER(aem)) {
-			aem->eep_wp_gpio_num = 4;
+		if (aem->chip) {
+			aem->eep_wp_gpio_num = aem->chip->eep_wp_gpio_num;
 			aem->eep_wp_gpio_pol = 0;
 		} else {
 			fprintf(stderr, "Unable to determine EEPROM unlocking GPIO, the feature will be disabled\n");
@@ -555,5 +774,7 @@ int hw_init(struct atheepmgr *aem)
 		}
 	}
 
+	TRACE_PROBE2(hw_init_exit, aem->macVersion, aem->macRev);
+
 	return 0;
 }
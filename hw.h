@@ -30,6 +30,13 @@
 #define AR_SREV_REVISION2	0x00000F00
 #define AR_SREV_REVISION2_S	8
 
+#define AR_ISR_RAC		0x00c0	/* Primary ISR read-and-clear */
+#define AR_ISR_S0_S		0x00c4	/* Secondary ISRs read-and-clear */
+#define AR_ISR_S1_S		0x00c8
+#define AR_ISR_S2_S		0x00cc
+#define AR_ISR_S3_S		0x00d0
+#define AR_ISR_S4_S		0x00d4
+
 #define AR5211_EEPROM_ADDR		0x6000
 
 #define AR5211_EEPROM_DATA		0x6004
@@ -48,9 +55,9 @@
 #define AR5416_EEPROM_S				2
 #define AR5416_EEPROM_OFFSET			0x2000
 
-#define AR_EEPROM_STATUS_DATA		(AR_SREV_9340(aem) ? 0x40c8 : \
-					 (AR_SREV_9300_20_OR_LATER(aem) ? \
-					  0x4084 : 0x407c))
+#define AR5416_EEPROM_STATUS_DATA	0x407c
+#define AR9300_EEPROM_STATUS_DATA	0x4084
+#define AR9340_EEPROM_STATUS_DATA	0x40c8
 #define AR_EEPROM_STATUS_DATA_VAL		0x0000ffff
 #define AR_EEPROM_STATUS_DATA_VAL_S		0
 #define AR_EEPROM_STATUS_DATA_BUSY		0x00010000
@@ -70,7 +77,8 @@
 
 #define AR5XXX_GPIO_IN		0x401c
 
-#define AR9XXX_GPIO_IN_OUT	(AR_SREV_9340(aem) ? 0x4028 : 0x4048)
+#define AR5416_GPIO_IN_OUT	0x4048
+#define AR9340_GPIO_IN_OUT	0x4028
 
 #define AR5416_GPIO_IN_VAL	0x0FFFC000
 #define AR5416_GPIO_IN_VAL_S	14
@@ -83,9 +91,9 @@
 #define AR9300_GPIO_IN_VAL	0x0001FFFF
 #define AR9300_GPIO_IN_VAL_S	0
 
-#define AR9XXX_GPIO_OE_OUT	(AR_SREV_9340(aem) ? 0x4030 : \
-				 (AR_SREV_9300_20_OR_LATER(aem) ? 0x4050 : \
-				  0x404c))
+#define AR5416_GPIO_OE_OUT	0x404c
+#define AR9300_GPIO_OE_OUT	0x4050
+#define AR9340_GPIO_OE_OUT	0x4030
 
 #define AR9XXX_GPIO_OE_OUT_DRV		0x3
 #define AR9XXX_GPIO_OE_OUT_DRV_NO	0x0
@@ -93,15 +101,9 @@
 #define AR9XXX_GPIO_OE_OUT_DRV_HI	0x2
 #define AR9XXX_GPIO_OE_OUT_DRV_ALL	0x3
 
-#define AR9XXX_GPIO_OUTPUT_MUX1	(AR_SREV_9340(aem) ? 0x4048 : \
-				 (AR_SREV_9300_20_OR_LATER(aem) ? 0x4068 : \
-				  0x4060))
-#define AR9XXX_GPIO_OUTPUT_MUX2	(AR_SREV_9340(aem) ? 0x404C : \
-				 (AR_SREV_9300_20_OR_LATER(aem) ? 0x406C : \
-				  0x4064))
-#define AR9XXX_GPIO_OUTPUT_MUX3	(AR_SREV_9340(aem) ? 0x4050 : \
-				 (AR_SREV_9300_20_OR_LATER(aem) ? 0x4070 : \
-				  0x4068))
+#define AR5416_GPIO_OUTPUT_MUX1	0x4060
+#define AR9300_GPIO_OUTPUT_MUX1	0x4068
+#define AR9340_GPIO_OUTPUT_MUX1	0x4048
 
 #define AR9XXX_GPIO_OUTPUT_MUX_MASK		0x1f
 #define AR9XXX_GPIO_OUTPUT_MUX_OUTPUT		0x00
@@ -110,4 +112,26 @@
 #define AR9XXX_GPIO_OUTPUT_MUX_MAC_NETWORK	0x05
 #define AR9XXX_GPIO_OUTPUT_MUX_MAC_POWER	0x06
 
+/**
+ * Chip registers layout & capabilities, which is selected once by the MAC
+ * version, so the access paths do not need to check the chip revision.
+ */
+struct hw_chip {
+	const char *name;
+	uint32_t mac_version;		/* Minimal MAC version */
+	bool exact;			/* Match only the exact MAC version */
+	unsigned gpio_num;		/* Number of GPIO lines */
+	int eep_wp_gpio_num;		/* Default EEPROM WP GPIO */
+	const struct gpio_ops *gpio;
+	const struct eep_ops *eep;
+	const uint32_t *nv_regs;	/* Cacheable regs, zero terminated */
+	uint32_t eep_status_data;	/* EEPROM status & data register */
+	uint32_t gpio_in_out;		/* GPIO input & output values */
+	uint32_t gpio_oe_out;		/* GPIO output enable (direction) */
+	uint32_t gpio_out_mux1;		/* First of three output mux registers */
+	uint32_t gpio_in_val;		/* GPIO input values field mask */
+	unsigned gpio_in_val_s;		/* GPIO input values field shift */
+	bool gpio_out_mux1_legacy;	/* Pre-AR9280 MUX1 layout */
+};
+
 #endif /* HW_H */
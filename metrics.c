@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/stat.h>
+#include <time.h>
+
+#include "atheepmgr.h"
+#include "utils.h"
+#include "hw.h"
+
+/**
+ * Metrics are written in the Prometheus text exposition format, which is
+ * consumed by the node-exporter textfile collector. The file is written via
+ * a temporary file and then renamed, so the collector never sees a partial
+ * file.
+ *
+ * With the cache=<file> option the fetched EEPROM image is saved to the
+ * cache file and on the next run only the integrity critical words (checksum
+ * and headers) are read from the EEPROM. If they match the cached image, then
+ * the cached image is parsed instead of the whole EEPROM reading. Data words
+ * corruption is not visible via these words, so the cache is trusted only for
+ * maxage=<sec> seconds (a day by default), then the whole EEPROM is read and
+ * checked again.
+ */
+
+#define MT_CACHE_MAXAGE_DEF	86400
+
+struct mt_stat {
+	const char *src;		/* EEPROM data source */
+	int check;			/* EEPROM check result */
+	unsigned long nreads;		/* Number of EEPROM words reads */
+	uint64_t dur;			/* EEPROM reading time, ns */
+	long cache_age;			/* Used cache age, s or -1 if no cache */
+};
+
+static size_t mt_cache_load(const char *path, uint16_t *buf, size_t bufsz,
+			    long *age)
+{
+	struct stat st;
+	FILE *fp;
+	size_t len;
+
+	fp = fopen(path, "rb");
+	if (!fp)
+		return 0;	/* Cache is not created yet */
+
+	if (fstat(fileno(fp), &st) != 0) {
+		fclose(fp);
+		return 0;
+	}
+	*age = time(NULL) - st.st_mtime;
+
+	len = fread(buf, sizeof(uint16_t), bufsz, fp);
+	fclose(fp);
+
+	return len;
+}
+
+/* NB: cache saving failure is not fatal, the next run reads EEPROM again */
+static void mt_cache_save(struct atheepmgr *aem, const char *path)
+{
+	char tmp[0x200];
+	FILE *fp;
+
+	snprintf(tmp, sizeof(tmp), "%s.%d", path, (int)getpid());
+	fp = fopen(tmp, "wb");
+	if (!fp)
+		goto err;
+	/**
+	 * NB: save the whole buffer since the parser could read beyond the
+	 * final EEPROM data length (e.g. while the 9300 map probes layouts)
+	 */
+	if (fwrite(aem->eep_buf, sizeof(uint16_t), aem->eepmap->eep_buf_sz,
+		   fp) != aem->eepmap->eep_buf_sz) {
+		fclose(fp);
+		goto err_unlink;
+	}
+	if (fclose(fp) != 0 || rename(tmp, path) != 0)
+		goto err_unlink;
+
+	return;
+
+err_unlink:
+	unlink(tmp);
+err:
+	fprintf(stderr, "Unable to save EEPROM cache %s: %s\n", path,
+		strerror(errno));
+}
+
+/*
+ * Check the integrity critical words of the cached image. Only maps with a
+ * checksum word covering the whole data are supported, since for the others
+ * (e.g. AR93xx compressed blocks) a data change can not be detected by the
+ * header words.
+ */
+static bool mt_cache_match(struct atheepmgr *aem, const uint16_t *buf,
+			   size_t len)
+{
+	const struct eepmap_area *area;
+	uint16_t word;
+	size_t off;
+
+	if (!aem->eepmap->prio_areas)
+		return false;
+
+	/* Cached data are normalized, so detect the device byte order first */
+	eep_detect_io_swap(aem, buf, len);
+
+	for (area = aem->eepmap->prio_areas; area->len; ++area) {
+		for (off = area->off; off < area->off + area->len; ++off) {
+			if (off >= len || !EEP_READ(off, &word) ||
+			    word != buf[off])
+				return false;
+		}
+	}
+
+	return true;
+}
+
+static int mt_fetch(struct atheepmgr *aem, const char *cache,
+		    unsigned long maxage, struct mt_stat *st)
+{
+	unsigned long nreads = aem->eep_nreads;
+	uint64_t start = time_mono_ns();
+	uint16_t *cbuf = NULL;
+	size_t clen = 0;
+	long age = 0;
+	bool res;
+
+	if (!aem->eepmap->csum_loc)
+		cache = NULL;	/* See mt_cache_match() */
+
+	if (cache) {
+		cbuf = malloc(aem->eepmap->eep_buf_sz * sizeof(uint16_t));
+		if (!cbuf) {
+			fprintf(stderr, "Unable to allocate memory for EEPROM cache\n");
+			return -ENOMEM;
+		}
+		clen = mt_cache_load(cache, cbuf, aem->eepmap->eep_buf_sz,
+				     &age);
+		if (clen && (age < 0 || age >= maxage)) {
+			if (aem->verbose)
+				printf("EEPROM cache is %ld s old, read the whole EEPROM\n",
+				       age);
+			clen = 0;
+		}
+	}
+
+	if (clen && mt_cache_match(aem, cbuf, clen)) {
+		st->dur = time_mono_ns() - start;
+		st->nreads = aem->eep_nreads - nreads;
+		st->src = "cache";
+		st->cache_age = age;
+		res = aem_fill_from_buf(aem, cbuf, clen);
+	} else {
+		res = eepmap_fill(aem);
+		st->dur = time_mono_ns() - start;
+		st->nreads = aem->eep_nreads - nreads;
+		st->src = "eeprom";
+		st->cache_age = cache ? 0 : -1;
+		if (res && cache)
+			mt_cache_save(aem, cache);
+	}
+
+	free(cbuf);
+
+	if (!res) {
+		fprintf(stderr, "Unable to fill EEPROM data\n");
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static void mt_print(FILE *fp, const char *name, const char *help)
+{
+	fprintf(fp, "# HELP atheepmgr_%s %s\n", name, help);
+	fprintf(fp, "# TYPE atheepmgr_%s gauge\n", name);
+}
+
+static void mt_write(struct atheepmgr *aem, FILE *fp, const struct mt_stat *st)
+{
+	uint32_t gpio;
+	int i;
+
+	if (aem->chip) {
+		mt_print(fp, "chip_info", "Chip name and revision.");
+		fprintf(fp, "atheepmgr_chip_info{chip=\"%s\",srev=\"0x%x\",rev=\"0x%x\"} 1\n",
+			aem->chip->name, aem->macVersion, aem->macRev);
+	}
+
+	mt_print(fp, "eepmap_info", "EEPROM map type.");
+	fprintf(fp, "atheepmgr_eepmap_info{map=\"%s\",source=\"%s\"} 1\n",
+		aem->eepmap->name, st->src);
+
+	mt_print(fp, "eeprom_check_ok", "EEPROM checksum and sanity check status.");
+	fprintf(fp, "atheepmgr_eeprom_check_ok %d\n", st->check ? 1 : 0);
+
+	if (aem->eepmap->valid_blocks) {
+		mt_print(fp, "eeprom_valid_blocks", "Number of valid EEPROM data blocks.");
+		fprintf(fp, "atheepmgr_eeprom_valid_blocks %d\n",
+			aem->eepmap->valid_blocks(aem));
+	}
+
+	if (aem->gpio) {
+		gpio = aem->gpio->input_get(aem);	/* Single snapshot */
+		mt_print(fp, "gpio_input", "GPIO input line state.");
+		for (i = 0; i < aem->gpio_num; ++i)
+			fprintf(fp, "atheepmgr_gpio_input{gpio=\"%d\"} %d\n", i,
+				gpio & BIT(i) ? 1 : 0);
+	}
+
+	if (st->cache_age >= 0) {
+		mt_print(fp, "eeprom_cache_age_seconds", "Age of the used EEPROM cache, 0 for fresh data.");
+		fprintf(fp, "atheepmgr_eeprom_cache_age_seconds %ld\n",
+			st->cache_age);
+	}
+
+	mt_print(fp, "eeprom_words_read", "Number of EEPROM words read by the last run.");
+	fprintf(fp, "atheepmgr_eeprom_words_read %lu\n", st->nreads);
+
+	mt_print(fp, "eeprom_read_seconds", "EEPROM reading time of the last run.");
+	fprintf(fp, "atheepmgr_eeprom_read_seconds %.6f\n", st->dur / 1e9);
+
+	if (st->nreads) {
+		mt_print(fp, "eeprom_read_latency_seconds", "Average EEPROM word read latency.");
+		fprintf(fp, "atheepmgr_eeprom_read_latency_seconds %.9f\n",
+			st->dur / 1e9 / st->nreads);
+	}
+
+	mt_print(fp, "last_run_timestamp_seconds", "Time of the last run.");
+	fprintf(fp, "atheepmgr_last_run_timestamp_seconds %llu\n",
+		(unsigned long long)time(NULL));
+}
+
+int act_eep_metrics(struct atheepmgr *aem, int argc, char *argv[])
+{
+	void *eepmap_priv = aem->eepmap_priv;
+	uint16_t *eep_buf = aem->eep_buf;
+	size_t eep_len = aem->eep_len;
+	unsigned long maxage = MT_CACHE_MAXAGE_DEF;
+	struct mt_stat st = {.cache_age = -1};
+	const char *cache = NULL;
+	bool own = false;
+	char tmp[0x200];
+	FILE *fp;
+	int i, ret;
+
+	if (argc < 1) {
+		fprintf(stderr, "Metrics file is not specified, aborting\n");
+		return -EINVAL;
+	}
+	for (i = 1; i < argc; ++i) {
+		if (strncmp(argv[i], "cache=", 6) == 0) {
+			cache = argv[i] + 6;
+		} else if (!parse_opt_ulong(argv[i], "maxage", &maxage)) {
+			fprintf(stderr, "Invalid metrics option -- %s\n",
+				argv[i]);
+			return -EINVAL;
+		}
+	}
+
+	if (eep_len) {
+		/* Reuse the data, which are already fetched for a chained action */
+		ret = 0;
+		st.src = "chain";
+		st.check = aem->eep_check;
+		goto write;
+	}
+
+	if (!aem->eepmap) {
+		if (!(aem->con->caps & CON_CAP_HW)) {
+			fprintf(stderr, "EEPROM map type option is mandatory for connectors without direct HW access\n");
+			return -EINVAL;
+		}
+		ret = eepmap_detect(aem);
+		if (ret)
+			return ret;
+	}
+
+	/* NB: use own buffers as probe does, see act_eep_probe() */
+	own = true;
+	aem->eepmap_priv = calloc(1, aem->eepmap->priv_data_sz);
+	aem->eep_buf = calloc(aem->eepmap->eep_buf_sz, sizeof(uint16_t));
+	if (!aem->eepmap_priv || !aem->eep_buf) {
+		fprintf(stderr, "Unable to allocate memory for EEPROM data\n");
+		ret = -ENOMEM;
+		goto exit;
+	}
+
+	/* NB: still export the metrics on reading failure to flag the card */
+	ret = mt_fetch(aem, cache, maxage, &st);
+	if (ret == -EIO)
+		st.src = "none";
+	else if (ret)
+		goto exit;
+	else
+		st.check = eepmap_check(aem);
+
+write:
+	snprintf(tmp, sizeof(tmp), "%s.%d", argv[0], (int)getpid());
+	fp = fopen(tmp, "w");
+	if (!fp) {
+		fprintf(stderr, "Unable to create metrics file %s: %s\n", tmp,
+			strerror(errno));
+		ret = -errno;
+		goto exit;
+	}
+	mt_write(aem, fp, &st);
+	if (fclose(fp) != 0 || rename(tmp, argv[0]) != 0) {
+		fprintf(stderr, "Unable to write metrics file %s: %s\n",
+			argv[0], strerror(errno));
+		unlink(tmp);
+		ret = -errno;
+		goto exit;
+	}
+
+exit:
+	if (own) {
+		free(aem->eepmap_priv);
+		free(aem->eep_buf);
+		aem->eepmap_priv = eepmap_priv;
+		aem->eep_buf = eep_buf;
+		aem->eep_len = eep_len;
+	}
+
+	return ret;
+}
@@ -0,0 +1,464 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "atheepmgr.h"
+#include "container.h"
+
+/**
+ * EEPROM patch file layout (all fields are little-endian):
+ *
+ *   header (struct patch_hdr)
+ *   entries (struct patch_ent) sorted by offset
+ *
+ * Each entry specifies the word offset, the expected original value and
+ * the new value. If the EEPROM map uses the XOR checksum and the patch
+ * changes the checksum consistently, then the checksum word is not listed
+ * as an entry, but updated on applying by XORing the device checksum with
+ * the patch checksum delta, so the same patch could be applied to devices
+ * with different calibration data (and so different checksums).
+ *
+ * The probe word is a word of the original image with different bytes,
+ * which is used to detect the device EEPROM byte order without a full
+ * EEPROM reading.
+ */
+
+#define PATCH_MAGIC		"AEMP"
+#define PATCH_MAGIC_LEN		4
+#define PATCH_VERSION		1
+
+#define PATCH_F_CSUM_XOR	0x01	/* Incremental checksum update */
+
+struct patch_hdr {
+	char magic[PATCH_MAGIC_LEN];
+	uint8_t version;
+	uint8_t flags;
+	uint16_t nents;			/* Number of entries */
+	char eepmap[8];			/* EEPROM map name */
+	uint16_t probe_off;		/* Byte order probe word offset */
+	uint16_t probe_val;		/* Byte order probe word value */
+	uint16_t csum_loc;		/* Checksum word offset, 0 - none */
+	uint16_t csum_old;		/* Original image checksum */
+	uint16_t csum_delta;		/* Checksum delta (XOR mode) */
+	uint16_t reserved;
+} __attribute__ ((packed));
+
+struct patch_ent {
+	uint16_t off;
+	uint16_t old;
+	uint16_t new;
+} __attribute__ ((packed));
+
+struct patch {
+	struct patch_hdr hdr;		/* Header in the host byte order */
+	const struct eepmap *eepmap;
+	struct patch_ent *ents;
+};
+
+static inline uint16_t patch_img_word(const uint16_t *buf, size_t len,
+				      size_t off)
+{
+	return off < len ? buf[off] : 0xffff;
+}
+
+static int patch_create(struct atheepmgr *aem, int argc, char *argv[])
+{
+	struct cont_info oinfo, ninfo;
+	const struct eepmap *eepmap;
+	struct patch_hdr hdr;
+	struct patch_ent ent;
+	uint16_t *obuf, *nbuf, delta = 0, csum_loc = 0;
+	size_t olen, nlen, len, off;
+	int nents = 0, ret;
+	FILE *fp;
+
+	if (argc < 3) {
+		fprintf(stderr, "Original, patched images and patch file should be specified, aborting\n");
+		return -EINVAL;
+	}
+
+	ret = cont_load_image(argv[0], &oinfo, &obuf, &olen);
+	if (ret)
+		return ret;
+	ret = cont_load_image(argv[1], &ninfo, &nbuf, &nlen);
+	if (ret)
+		goto err_free_obuf;
+
+	eepmap = aem->eepmap ? aem->eepmap : oinfo.eepmap;
+	if (eepmap && ninfo.eepmap && ninfo.eepmap != eepmap) {
+		fprintf(stderr, "Images have different EEPROM map types, aborting\n");
+		ret = -EINVAL;
+		goto err_free_nbuf;
+	}
+	if (!eepmap)
+		eepmap = ninfo.eepmap;
+	if (!eepmap)
+		printf("EEPROM map type is unknown, checksum word will be patched as a regular word\n");
+
+	len = olen > nlen ? olen : nlen;
+	if (len > 0xffff) {
+		fprintf(stderr, "Image is too big for patching\n");
+		ret = -EFBIG;
+		goto err_free_nbuf;
+	}
+
+	memset(&hdr, 0x00, sizeof(hdr));
+	memcpy(hdr.magic, PATCH_MAGIC, PATCH_MAGIC_LEN);
+	hdr.version = PATCH_VERSION;
+	if (eepmap)
+		memcpy(hdr.eepmap, eepmap->name,
+		       strnlen(eepmap->name, sizeof(hdr.eepmap)));
+
+	/* Check whether the checksum could be updated incrementally */
+	if (eepmap && eepmap->csum_loc && eepmap->csum_loc < len) {
+		csum_loc = eepmap->csum_loc;
+		hdr.csum_loc = htole16(csum_loc);
+		for (off = 0; off < len; ++off)
+			if (off != csum_loc)
+				delta ^= patch_img_word(obuf, olen, off) ^
+					 patch_img_word(nbuf, nlen, off);
+		hdr.csum_old = htole16(patch_img_word(obuf, olen, csum_loc));
+		if ((patch_img_word(obuf, olen, csum_loc) ^
+		     patch_img_word(nbuf, nlen, csum_loc)) == delta) {
+			hdr.flags |= PATCH_F_CSUM_XOR;
+			hdr.csum_delta = htole16(delta);
+		} else {
+			printf("Checksum change does not match the data change, checksum word will be patched as a regular word\n");
+			csum_loc = 0;
+		}
+	}
+
+	for (off = 0; off < olen; ++off) {
+		if ((obuf[off] >> 8) != (obuf[off] & 0xff)) {
+			hdr.probe_off = htole16(off);
+			hdr.probe_val = htole16(obuf[off]);
+			break;
+		}
+	}
+
+	fp = fopen(argv[2], "wb");
+	if (!fp) {
+		fprintf(stderr, "Unable to open patch file for writing: %s\n",
+			strerror(errno));
+		ret = -errno;
+		goto err_free_nbuf;
+	}
+
+	if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1)
+		goto err_write;
+
+	for (off = 0; off < len; ++off) {
+		ent.old = patch_img_word(obuf, olen, off);
+		ent.new = patch_img_word(nbuf, nlen, off);
+		if (ent.old == ent.new || (csum_loc && off == csum_loc))
+			continue;
+		ent.off = htole16(off);
+		ent.old = htole16(ent.old);
+		ent.new = htole16(ent.new);
+		if (fwrite(&ent, sizeof(ent), 1, fp) != 1)
+			goto err_write;
+		nents++;
+	}
+
+	hdr.nents = htole16(nents);
+	if (fseek(fp, 0, SEEK_SET) != 0 || fwrite(&hdr, sizeof(hdr), 1, fp) != 1)
+		goto err_write;
+
+	if (fclose(fp) != 0) {
+		fprintf(stderr, "Unable to save patch: %s\n", strerror(errno));
+		ret = -EIO;
+		goto err_free_nbuf;
+	}
+
+	printf("Patch of %d word(s)%s saved to %s (%zu bytes)\n", nents,
+	       csum_loc ? " + checksum" : "", argv[2],
+	       sizeof(hdr) + nents * sizeof(ent));
+
+	free(nbuf);
+	free(obuf);
+
+	return 0;
+
+err_write:
+	fprintf(stderr, "Unable to write patch: %s\n", strerror(errno));
+	fclose(fp);
+	unlink(argv[2]);
+	ret = -EIO;
+err_free_nbuf:
+	free(nbuf);
+err_free_obuf:
+	free(obuf);
+
+	return ret;
+}
+
+static int patch_load(const char *fname, struct patch *patch)
+{
+	struct patch_hdr *hdr = &patch->hdr;
+	char name[sizeof(hdr->eepmap) + 1];
+	FILE *fp;
+	int i;
+
+	fp = fopen(fname, "rb");
+	if (!fp) {
+		fprintf(stderr, "Unable to open patch file '%s': %s\n", fname,
+			strerror(errno));
+		return -errno;
+	}
+
+	if (fread(hdr, sizeof(*hdr), 1, fp) != 1 ||
+	    memcmp(hdr->magic, PATCH_MAGIC, PATCH_MAGIC_LEN) != 0) {
+		fprintf(stderr, "File '%s' is not an EEPROM patch\n", fname);
+		fclose(fp);
+		return -EINVAL;
+	}
+	if (hdr->version != PATCH_VERSION) {
+		fprintf(stderr, "Unsupported patch version %u\n", hdr->version);
+		fclose(fp);
+		return -EINVAL;
+	}
+
+	hdr->nents = le16toh(hdr->nents);
+	hdr->probe_off = le16toh(hdr->probe_off);
+	hdr->probe_val = le16toh(hdr->probe_val);
+	hdr->csum_loc = le16toh(hdr->csum_loc);
+	hdr->csum_old = le16toh(hdr->csum_old);
+	hdr->csum_delta = le16toh(hdr->csum_delta);
+
+	memcpy(name, hdr->eepmap, sizeof(hdr->eepmap));
+	name[sizeof(hdr->eepmap)] = '\0';
+	patch->eepmap = name[0] ? eepmap_find_by_name(name) : NULL;
+	if (name[0] && !patch->eepmap) {
+		fprintf(stderr, "Patch has unknown EEPROM map type %s\n", name);
+		fclose(fp);
+		return -EINVAL;
+	}
+
+	patch->ents = malloc((hdr->nents ? hdr->nents : 1) *
+			     sizeof(patch->ents[0]));
+	if (!patch->ents) {
+		fprintf(stderr, "Unable to allocate memory for patch\n");
+		fclose(fp);
+		return -ENOMEM;
+	}
+	if (fread(patch->ents, sizeof(patch->ents[0]), hdr->nents, fp) !=
+	    hdr->nents) {
+		fprintf(stderr, "Patch file '%s' is truncated\n", fname);
+		free(patch->ents);
+		fclose(fp);
+		return -EINVAL;
+	}
+	fclose(fp);
+
+	for (i = 0; i < hdr->nents; ++i) {
+		patch->ents[i].off = le16toh(patch->ents[i].off);
+		patch->ents[i].old = le16toh(patch->ents[i].old);
+		patch->ents[i].new = le16toh(patch->ents[i].new);
+	}
+
+	return 0;
+}
+
+/* Detect device byte order by the probe word */
+static void patch_probe_io_swap(struct atheepmgr *aem,
+				const struct patch_hdr *hdr)
+{
+	uint16_t word;
+
+	if (!hdr->probe_val || !EEP_READ(hdr->probe_off, &word))
+		return;
+
+	if (word == bswap_16(hdr->probe_val)) {
+		aem->eep_io_swap = !aem->eep_io_swap;
+		if (aem->verbose)
+			printf("Device EEPROM data are byteswapped\n");
+	}
+}
+
+static int patch_apply(struct atheepmgr *aem, const struct patch *patch,
+		       bool strict)
+{
+	const struct patch_hdr *hdr = &patch->hdr;
+	int i, nold = 0, nnew = 0;
+	uint16_t word, csum = 0;
+	bool xor = hdr->flags & PATCH_F_CSUM_XOR;
+
+	patch_probe_io_swap(aem, hdr);
+
+	/* Validate preconditions before any modification */
+	for (i = 0; i < hdr->nents; ++i) {
+		if (!EEP_READ(patch->ents[i].off, &word)) {
+			fprintf(stderr, "Unable to read EEPROM at 0x%04x\n",
+				patch->ents[i].off);
+			return -EIO;
+		}
+		if (word == patch->ents[i].old) {
+			nold++;
+		} else if (word == patch->ents[i].new) {
+			nnew++;
+		} else {
+			fprintf(stderr, "Precondition failed at 0x%04x: 0x%04x, expected 0x%04x\n",
+				patch->ents[i].off, word, patch->ents[i].old);
+			return -EBADMSG;
+		}
+	}
+
+	if (xor || strict) {
+		if (!EEP_READ(hdr->csum_loc, &csum)) {
+			fprintf(stderr, "Unable to read EEPROM checksum\n");
+			return -EIO;
+		}
+		if (strict && csum != hdr->csum_old) {
+			fprintf(stderr, "Precondition failed: checksum 0x%04x, expected 0x%04x\n",
+				csum, hdr->csum_old);
+			return -EBADMSG;
+		}
+	}
+
+	/**
+	 * All data words are patched, but applying could be interrupted before
+	 * the checksum update. This is detectable only if the device checksum
+	 * matches the original image one, otherwise the checksum could be
+	 * already updated from the device own original value.
+	 */
+	if (!nold && xor && csum != (hdr->csum_old ^ hdr->csum_delta)) {
+		if (csum != hdr->csum_old) {
+			printf("Patch data are already applied, but the checksum 0x%04x does not match the patched image, verify it with the 'dump' action\n",
+			       csum);
+			return 0;
+		}
+		printf("Patch data are already applied, update checksum\n");
+		EEP_UNLOCK();
+		if (!EEP_WRITE(hdr->csum_loc, csum ^ hdr->csum_delta)) {
+			fprintf(stderr, "Unable to update EEPROM checksum\n");
+			goto err_unlock;
+		}
+		EEP_LOCK();
+		printf("Patch applied: checksum updated\n");
+		return 0;
+	}
+
+	if (!nold) {
+		printf("Patch is already applied\n");
+		return 0;
+	}
+
+	/**
+	 * NB: the checksum word is written last, so if applying has been
+	 * interrupted, the device checksum still corresponds to the original
+	 * data and the full delta should be applied on the next run.
+	 */
+	if (nnew)
+		printf("Patch is partially applied, continue applying\n");
+
+	EEP_UNLOCK();
+
+	for (i = 0; i < hdr->nents; ++i) {
+		if (patch->ents[i].off == hdr->csum_loc && !xor)
+			continue;	/* Write checksum last */
+		if (!EEP_WRITE(patch->ents[i].off, patch->ents[i].new))
+			goto err_write;
+	}
+	for (i = 0; i < hdr->nents; ++i) {
+		if (patch->ents[i].off != hdr->csum_loc || xor)
+			continue;
+		if (!EEP_WRITE(patch->ents[i].off, patch->ents[i].new))
+			goto err_write;
+	}
+	if (xor && !EEP_WRITE(hdr->csum_loc, csum ^ hdr->csum_delta)) {
+		fprintf(stderr, "Unable to update EEPROM checksum\n");
+		goto err_unlock;
+	}
+
+	EEP_LOCK();
+
+	printf("Patch applied: %d word(s) written%s\n", nold,
+	       xor ? ", checksum updated" : "");
+
+	return 0;
+
+err_write:
+	fprintf(stderr, "Unable to write EEPROM at 0x%04x\n",
+		patch->ents[i].off);
+err_unlock:
+	EEP_LOCK();
+
+	return -EIO;
+}
+
+int act_eep_patch(struct atheepmgr *aem, int argc, char *argv[])
+{
+	struct patch patch;
+	bool strict = false;
+	int ret;
+
+	if (argc >= 1 && strcasecmp(argv[0], "create") == 0)
+		return patch_create(aem, argc - 1, argv + 1);
+
+	if (argc < 2 || strcasecmp(argv[0], "apply") != 0) {
+		fprintf(stderr, "Patch operation should be 'create' or 'apply', aborting\n");
+		return -EINVAL;
+	}
+
+	if (argc >= 3) {
+		if (strcasecmp(argv[2], "strict") != 0) {
+			fprintf(stderr, "Unknown patch option -- %s\n", argv[2]);
+			return -EINVAL;
+		}
+		strict = true;
+	}
+
+	if (!aem->con) {
+		fprintf(stderr, "Connector is not specified\n");
+		return -EINVAL;
+	}
+
+	ret = patch_load(argv[1], &patch);
+	if (ret)
+		return ret;
+
+	if (strict && !patch.hdr.csum_loc) {
+		fprintf(stderr, "Patch has no checksum info for strict applying\n");
+		ret = -EINVAL;
+		goto exit;
+	}
+
+	ret = aem_attach(aem, ACT_F_EEPIO);
+	if (ret)
+		goto exit;
+
+	/* Map type is cheap to detect for HW, so do not rely on user */
+	if (!aem->eepmap && (aem->con->caps & CON_CAP_HW)) {
+		ret = eepmap_detect(aem);
+		if (ret)
+			goto detach;
+	}
+	if (aem->eepmap && patch.eepmap && aem->eepmap != patch.eepmap) {
+		fprintf(stderr, "Patch is intended for %s EEPROM map, aborting\n",
+			patch.eepmap->name);
+		ret = -EINVAL;
+		goto detach;
+	}
+
+	ret = patch_apply(aem, &patch, strict);
+
+detach:
+	aem_detach(aem);
+
+exit:
+	free(patch.ents);
+
+	return ret;
+}
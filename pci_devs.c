@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "atheepmgr.h"
+#include "con_pci.h"
+
+/* Check PCI device IDs, shared by the connectors, which bind to PCI devices */
+int pci_is_supported_chipset(struct atheepmgr *aem, uint16_t vendor_id,
+			     uint16_t device_id)
+{
+	static const struct {
+		uint16_t dev_id;
+		const char *name;
+	} devs[] = {
+		{AR5211_DEVID_PCI,  "AR5211 PCI"},
+		{AR5212_DEVID_PCI,  "AR5212/AR5213 PCI"},
+		{AR5413_DEVID_PCI,  "AR5413/AR5414 PCI"},
+		{AR5416_DEVID_PCI,  "AR5416 PCI"},
+		{AR5416_DEVID_PCIE, "AR5416 PCIe"},
+		{AR9160_DEVID_PCI,  "AR9160 PCI"},
+		{AR9280_DEVID_PCI,  "AR9280 PCI"},
+		{AR9280_DEVID_PCIE, "AR9280 PCIe"},
+		{AR9285_DEVID_PCIE, "AR9285 PCIe"},
+		{AR9287_DEVID_PCI,  "AR9287 PCI"},
+		{AR9287_DEVID_PCIE, "AR9287 PCIe"},
+		{AR9300_DEVID_PCIE, "AR9300 PCIe"},
+		{AR9485_DEVID_PCIE, "AR9485 PCIe"},
+		{AR9580_DEVID_PCIE, "AR9580 PCIe"},
+		{AR9462_DEVID_PCIE, "AR9462 PCIe"},
+		{AR9565_DEVID_PCIE, "AR9565 PCIe"},
+		{AR1111_DEVID_PCIE, "AR1111 PCIe"},
+	};
+	int i;
+
+	if (vendor_id != ATHEROS_VENDOR_ID)
+		goto not_supported;
+
+	for (i = 0; i < ARRAY_SIZE(devs); ++i)
+		if (devs[i].dev_id == device_id)
+			break;
+
+	if (i == ARRAY_SIZE(devs))
+		goto not_supported;
+
+	if (aem->verbose)
+		printf("Found Device: %04x:%04x (%s)\n", vendor_id, device_id,
+		       devs[i].name);
+
+	return 1;
+
+not_supported:
+	fprintf(stderr, "Device: %04x:%04x not supported\n", vendor_id,
+		device_id);
+
+	return 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "atheepmgr.h"
+#include "hw.h"
+
+/**
+ * Fetch the inventory data (chip, EEPROM map, MAC address, regdomain and
+ * optionally the checksum status) by reading only the required EEPROM words
+ * instead of the whole EEPROM fetching and parsing.
+ */
+int act_eep_probe(struct atheepmgr *aem, int argc, char *argv[])
+{
+	void *eepmap_priv = aem->eepmap_priv;
+	uint16_t *eep_buf = aem->eep_buf;
+	size_t eep_len = aem->eep_len;
+	unsigned long nreads = aem->eep_nreads;
+	struct eep_probe res;
+	bool csum = false;
+	int ret;
+
+	if (argc > 0) {
+		if (strcmp(argv[0], "csum") != 0) {
+			fprintf(stderr, "Invalid probe option -- %s\n", argv[0]);
+			return -EINVAL;
+		}
+		csum = true;
+	}
+
+	if (!aem->eepmap) {
+		if (!(aem->con->caps & CON_CAP_HW)) {
+			fprintf(stderr, "EEPROM map type option is mandatory for connectors without direct HW access\n");
+			return -EINVAL;
+		}
+		ret = eepmap_detect(aem);
+		if (ret)
+			return ret;
+	}
+
+	if (!aem->eepmap->probe) {
+		fprintf(stderr, "EEPROM map does not support probing, aborting\n");
+		return -EOPNOTSUPP;
+	}
+
+	/* NB: use own buffers to keep the fetched data of chained actions */
+	aem->eepmap_priv = calloc(1, aem->eepmap->priv_data_sz);
+	aem->eep_buf = calloc(aem->eepmap->eep_buf_sz, sizeof(uint16_t));
+	aem->eep_len = 0;
+	if (!aem->eepmap_priv || !aem->eep_buf) {
+		fprintf(stderr, "Unable to allocate memory for EEPROM probing\n");
+		ret = -ENOMEM;
+		goto exit;
+	}
+
+	if (!aem->eepmap->probe(aem, &res, csum)) {
+		fprintf(stderr, "EEPROM probing failed\n");
+		ret = -EIO;
+		goto exit;
+	}
+
+	if (aem->chip)
+		printf("chip=%s srev=0x%x/0x%x ", aem->chip->name,
+		       aem->macVersion, aem->macRev);
+	printf("map=%s mac=%02x:%02x:%02x:%02x:%02x:%02x regdmn=0x%04x,0x%04x csum=%s words=%lu\n",
+	       aem->eepmap->name, res.mac[0], res.mac[1], res.mac[2],
+	       res.mac[3], res.mac[4], res.mac[5], res.regdmn[0],
+	       res.regdmn[1], res.csum < 0 ? "unchecked" :
+	       res.csum ? "ok" : "bad", aem->eep_nreads - nreads);
+	ret = 0;
+
+exit:
+	free(aem->eepmap_priv);
+	free(aem->eep_buf);
+	aem->eepmap_priv = eepmap_priv;
+	aem->eep_buf = eep_buf;
+	aem->eep_len = eep_len;
+
+	return ret;
+}
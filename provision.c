@@ -0,0 +1,354 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/file.h>
+#include <time.h>
+
+#include "atheepmgr.h"
+#include "utils.h"
+#include "trace.h"
+
+/**
+ * MAC addresses pool file format (text):
+ *
+ *   range <first> <last>
+ *   <addr> <time> <target>
+ *   ...
+ *
+ * The first line specifies the pool range, each next line records the
+ * issued address. The pool file is locked with flock(2) while an address
+ * is allocated, so several utility instances could share the same pool.
+ */
+
+struct macset {
+	uint64_t *tbl;		/* Open addressing table, 0 is an empty slot */
+	size_t sz;		/* Table size, power of 2 */
+	size_t num;		/* Number of addresses in the set */
+};
+
+struct pool {
+	FILE *fp;
+	uint64_t first;
+	uint64_t last;
+	uint64_t next;		/* Next address to issue */
+	uint64_t max;		/* Max issued address */
+	long pos;		/* Parsed part of the file */
+	struct macset issued;
+};
+
+static uint64_t mac2u64(const uint8_t *mac)
+{
+	uint64_t val = 0;
+	int i;
+
+	for (i = 0; i < 6; ++i)
+		val = (val << 8) | mac[i];
+
+	return val;
+}
+
+static void u642mac(uint64_t val, uint8_t *mac)
+{
+	int i;
+
+	for (i = 5; i >= 0; --i, val >>= 8)
+		mac[i] = val & 0xff;
+}
+
+static size_t macset_slot(const struct macset *set, uint64_t val)
+{
+	/* Addresses are mostly sequential, so mix the bits before masking */
+	return (val * 0x9e3779b97f4a7c15ULL >> 20) & (set->sz - 1);
+}
+
+static bool macset_has(const struct macset *set, uint64_t val)
+{
+	size_t i;
+
+	if (!set->sz)
+		return false;
+
+	for (i = macset_slot(set, val); set->tbl[i]; i = (i + 1) & (set->sz - 1))
+		if (set->tbl[i] == val)
+			return true;
+
+	return false;
+}
+
+static int macset_add(struct macset *set, uint64_t val)
+{
+	uint64_t *old = set->tbl;
+	size_t i, oldsz = set->sz;
+
+	if (macset_has(set, val))
+		return 0;
+
+	if ((set->num + 1) * 2 > set->sz) {	/* Keep load factor <= 0.5 */
+		set->sz = set->sz ? set->sz * 2 : 64;
+		set->tbl = calloc(set->sz, sizeof(set->tbl[0]));
+		if (!set->tbl) {
+			fprintf(stderr, "Unable to allocate memory for MAC set\n");
+			set->tbl = old;
+			set->sz = oldsz;
+			return -ENOMEM;
+		}
+		set->num = 0;
+		for (i = 0; i < oldsz; ++i)
+			if (old[i])
+				macset_add(set, old[i]);
+		free(old);
+	}
+
+	for (i = macset_slot(set, val); set->tbl[i]; i = (i + 1) & (set->sz - 1));
+	set->tbl[i] = val;
+	set->num++;
+
+	return 0;
+}
+
+static int pool_parse_range(const char *str, uint64_t *first, uint64_t *last)
+{
+	uint8_t mac[6];
+	const char *p;
+
+	p = strchr(str, '-');
+	if (!p || macaddr_parse(str, mac) != 0)
+		return -EINVAL;
+	*first = mac2u64(mac);
+	if (macaddr_parse(p + 1, mac) != 0)
+		return -EINVAL;
+	*last = mac2u64(mac);
+
+	return *first <= *last ? 0 : -EINVAL;
+}
+
+/**
+ * Read the records, which are appended to the locked pool file since the
+ * last call (e.g. by other instances), and select the next address to issue
+ */
+static int pool_load(struct pool *pool)
+{
+	char line[0x200], first[0x20], last[0x20];
+	uint8_t mac[6], mac_last[6];
+	uint64_t val;
+	int ret;
+
+	fseek(pool->fp, pool->pos, SEEK_SET);
+
+	while (fgets(line, sizeof(line), pool->fp)) {
+		if (line[0] == '#' || line[0] == '\n')
+			continue;
+		if (strncmp(line, "range ", 6) == 0) {
+			if (sscanf(line + 6, "%19s %19s", first, last) != 2 ||
+			    macaddr_parse(first, mac) != 0 ||
+			    macaddr_parse(last, mac_last) != 0) {
+				fprintf(stderr, "Invalid pool range line: %s", line);
+				return -EINVAL;
+			}
+			pool->first = mac2u64(mac);
+			pool->last = mac2u64(mac_last);
+			continue;
+		}
+		if (macaddr_parse(line, mac) != 0)
+			continue;
+		val = mac2u64(mac);
+		ret = macset_add(&pool->issued, val);
+		if (ret)
+			return ret;
+		if (val > pool->max)
+			pool->max = val;
+	}
+	pool->pos = ftell(pool->fp);
+
+	if (!pool->last) {
+		fprintf(stderr, "MAC pool range is not specified\n");
+		return -EINVAL;
+	}
+
+	pool->next = pool->max >= pool->first && pool->max < pool->last ?
+		     pool->max + 1 : pool->first;
+
+	return 0;
+}
+
+static int pool_alloc(struct pool *pool, const char *target, uint8_t *mac)
+{
+	uint64_t val, start;
+	int ret;
+
+	flock(fileno(pool->fp), LOCK_EX);
+
+	ret = pool_load(pool);
+	if (ret)
+		goto exit;
+
+	/* Skip already issued addresses (e.g. imported from elsewhere) */
+	for (start = val = pool->next; macset_has(&pool->issued, val); ) {
+		val = val < pool->last ? val + 1 : pool->first;
+		if (val == start)
+			break;
+	}
+	if (macset_has(&pool->issued, val)) {
+		fprintf(stderr, "MAC pool is exhausted\n");
+		ret = -ENOSPC;
+		goto exit;
+	}
+
+	u642mac(val, mac);
+	fseek(pool->fp, 0, SEEK_END);
+	fprintf(pool->fp, "%02x:%02x:%02x:%02x:%02x:%02x %llu %s\n",
+		mac[0], mac[1], mac[2], mac[3], mac[4], mac[5],
+		(unsigned long long)time(NULL), target);
+	if (fflush(pool->fp) != 0 || fsync(fileno(pool->fp)) != 0) {
+		fprintf(stderr, "Unable to update MAC pool: %s\n",
+			strerror(errno));
+		ret = -EIO;
+		goto exit;
+	}
+	pool->pos = ftell(pool->fp);
+	macset_add(&pool->issued, val);
+	if (val > pool->max)
+		pool->max = val;
+
+exit:
+	flock(fileno(pool->fp), LOCK_UN);
+
+	return ret;
+}
+
+static int provision_target(struct atheepmgr *aem, struct pool *pool,
+			    const char *target)
+{
+	const struct eepmap *eepmap = aem->eepmap;
+	int wp_gpio_num = aem->eep_wp_gpio_num;
+	int wp_gpio_pol = aem->eep_wp_gpio_pol;
+	uint8_t mac[6];
+	bool res;
+	int ret;
+
+	if (target[0] == '\0' || target[1] != ':' ||
+	    !(aem->con = con_find_by_opt(target[0]))) {
+		fprintf(stderr, "%s: invalid target, should be in form <con>:<arg>\n",
+			target);
+		return -EINVAL;
+	}
+	aem->con_arg = target + 2;
+
+	ret = aem_attach(aem, ACT_F_EEPROM);
+	if (ret)
+		goto exit;
+
+	if (!aem->eepmap->update_eeprom ||
+	    !(aem->eepmap->params_mask & BIT(EEP_UPDATE_MAC))) {
+		fprintf(stderr, "%s: EEPROM map does not support MAC address updation\n",
+			target);
+		ret = -EOPNOTSUPP;
+		goto detach;
+	}
+
+	ret = pool_alloc(pool, target, mac);
+	if (ret)
+		goto detach;
+
+	EEP_UNLOCK();
+	TRACE_PROBE1(eep_update_enter, EEP_UPDATE_MAC);
+	trace_begin(aem, "update", "mac");
+	res = aem->eepmap->update_eeprom(aem, EEP_UPDATE_MAC, mac);
+	trace_end(aem, "update", res);
+	TRACE_PROBE2(eep_update_exit, EEP_UPDATE_MAC, res);
+	EEP_LOCK();
+
+	if (res) {
+		printf("%s: %02x:%02x:%02x:%02x:%02x:%02x\n", target, mac[0],
+		       mac[1], mac[2], mac[3], mac[4], mac[5]);
+	} else {
+		fprintf(stderr, "%s: MAC address updation failed\n", target);
+		ret = -EIO;
+	}
+
+detach:
+	aem_detach(aem);
+exit:
+	/**
+	 * Restore the map type (-t option or autodetection) and the EEPROM
+	 * unlocking GPIO autodetection mode, since hw_init() replaces the
+	 * latter with the previous target chip GPIO number and polarity
+	 */
+	aem->eepmap = eepmap;
+	aem->eep_wp_gpio_num = wp_gpio_num;
+	aem->eep_wp_gpio_pol = wp_gpio_pol;
+	aem->con = NULL;
+	aem->con_arg = NULL;
+
+	return ret;
+}
+
+int act_eep_provision(struct atheepmgr *aem, int argc, char *argv[])
+{
+	struct pool __pool = {0}, *pool = &__pool;
+	uint64_t first, last;
+	uint8_t mf[6], ml[6];
+	int i, nfail = 0, ret;
+	unsigned tid;
+
+	if (argc < 2) {
+		fprintf(stderr, "MAC pool file and targets should be specified, aborting\n");
+		return -EINVAL;
+	}
+
+	pool->fp = fopen(argv[0], "a+");
+	if (!pool->fp) {
+		fprintf(stderr, "Unable to open MAC pool file '%s': %s\n",
+			argv[0], strerror(errno));
+		return -errno;
+	}
+
+	/* Optional range argument initializes a new pool */
+	if (pool_parse_range(argv[1], &first, &last) == 0) {
+		u642mac(first, mf);
+		u642mac(last, ml);
+		fseek(pool->fp, 0, SEEK_END);
+		if (ftell(pool->fp) != 0) {
+			fprintf(stderr, "MAC pool file '%s' is already initialized\n",
+				argv[0]);
+			ret = -EEXIST;
+			goto exit;
+		}
+		fprintf(pool->fp, "range %02x:%02x:%02x:%02x:%02x:%02x %02x:%02x:%02x:%02x:%02x:%02x\n",
+			mf[0], mf[1], mf[2], mf[3], mf[4], mf[5],
+			ml[0], ml[1], ml[2], ml[3], ml[4], ml[5]);
+		fflush(pool->fp);
+		argc--;
+		argv++;
+	}
+
+	tid = aem->trace_tid;
+	for (i = 1; i < argc; ++i) {
+		trace_track(aem, argv[i]);	/* Own trace track per target */
+		if (provision_target(aem, pool, argv[i]) != 0)
+			nfail++;
+	}
+	aem->trace_tid = tid;
+
+	printf("Provisioned %d of %d target(s)\n", argc - 1 - nfail, argc - 1);
+	ret = nfail ? -EIO : 0;
+
+exit:
+	free(pool->issued.tbl);
+	fclose(pool->fp);
+
+	return ret;
+}
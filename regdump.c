@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "atheepmgr.h"
+#include "hw.h"
+#include "eep_9300.h"
+
+/**
+ * Registers snapshot file layout (all fields are little-endian):
+ *
+ *   header (struct regsnap_hdr)
+ *   skipped windows (struct regsnap_skip) x nskips
+ *   register values (uint32_t) x count
+ *
+ * Values of registers inside the skipped windows are not read (reading
+ * of them has side effects) and stored as zeros.
+ */
+
+#define REGSNAP_MAGIC		"AEMR"
+#define REGSNAP_MAGIC_LEN	4
+#define REGSNAP_VERSION		1
+
+struct regsnap_hdr {
+	char magic[REGSNAP_MAGIC_LEN];
+	uint8_t version;
+	uint8_t reserved;
+	uint16_t nskips;		/* Number of skipped windows */
+	uint32_t mac_version;
+	uint16_t mac_rev;
+	uint16_t reserved2;
+	uint32_t start;			/* First register address */
+	uint32_t count;			/* Number of registers */
+} __attribute__ ((packed));
+
+struct regsnap_skip {
+	uint32_t start;
+	uint32_t end;			/* Window end (not included) */
+} __attribute__ ((packed));
+
+#define REGSNAP_SKIPS_MAX	4
+
+struct regsnap {
+	uint32_t mac_version;
+	uint16_t mac_rev;
+	uint32_t start;
+	uint32_t count;
+	int nskips;
+	struct regsnap_skip skips[REGSNAP_SKIPS_MAX];
+	uint32_t *regs;
+};
+
+static void regsnap_skip_add(struct regsnap *snap, uint32_t start,
+			     uint32_t end)
+{
+	snap->skips[snap->nskips].start = start;
+	snap->skips[snap->nskips].end = end;
+	snap->nskips++;
+}
+
+/* Fill the list of windows, which reading has side effects */
+static void regsnap_skips_init(struct atheepmgr *aem, struct regsnap *snap)
+{
+	snap->nskips = 0;
+
+	if (AR_SREV_5416_OR_LATER(aem)) {
+		/* Each read starts an EEPROM access */
+		regsnap_skip_add(snap, AR5416_EEPROM_OFFSET,
+				 AR5416_EEPROM_OFFSET + 0x2000);
+	} else if (AR_SREV_5211_OR_LATER(aem)) {
+		/* EEPROM data register read could complete pending access */
+		regsnap_skip_add(snap, AR5211_EEPROM_DATA,
+				 AR5211_EEPROM_DATA + 4);
+	}
+
+	if (AR_SREV_9300_20_OR_LATER(aem)) {
+		/* Each read starts an OTP access */
+		regsnap_skip_add(snap, AR9300_OTP_BASE,
+				 AR9300_OTP_BASE + 0x2000);
+	}
+
+	if (AR_SREV_5211_OR_LATER(aem)) {
+		/* Read-and-clear shadows of the primary and secondary ISRs */
+		regsnap_skip_add(snap, AR_ISR_RAC, AR_ISR_S4_S + 4);
+	}
+}
+
+static bool regsnap_is_skipped(const struct regsnap *snap, uint32_t addr)
+{
+	int i;
+
+	for (i = 0; i < snap->nskips; ++i)
+		if (addr >= snap->skips[i].start && addr < snap->skips[i].end)
+			return true;
+
+	return false;
+}
+
+static int regsnap_read(struct atheepmgr *aem, struct regsnap *snap,
+			uint32_t start, uint32_t end)
+{
+	uint32_t addr, i;
+
+	snap->mac_version = aem->macVersion;
+	snap->mac_rev = aem->macRev;
+	snap->start = start;
+	snap->count = (end - start) / 4;
+	regsnap_skips_init(aem, snap);
+
+	snap->regs = calloc(snap->count ? snap->count : 1, sizeof(uint32_t));
+	if (!snap->regs) {
+		fprintf(stderr, "Unable to allocate memory for registers snapshot\n");
+		return -ENOMEM;
+	}
+
+	for (i = 0, addr = start; i < snap->count; ++i, addr += 4)
+		if (!regsnap_is_skipped(snap, addr))
+			snap->regs[i] = REG_READ(addr);
+
+	return 0;
+}
+
+static int regsnap_save(const struct regsnap *snap, const char *fname)
+{
+	struct regsnap_hdr hdr;
+	struct regsnap_skip skip;
+	uint32_t i, val;
+	FILE *fp;
+
+	fp = fopen(fname, "wb");
+	if (!fp) {
+		fprintf(stderr, "Unable to open snapshot file for writing: %s\n",
+			strerror(errno));
+		return -errno;
+	}
+
+	memset(&hdr, 0x00, sizeof(hdr));
+	memcpy(hdr.magic, REGSNAP_MAGIC, REGSNAP_MAGIC_LEN);
+	hdr.version = REGSNAP_VERSION;
+	hdr.nskips = htole16(snap->nskips);
+	hdr.mac_version = htole32(snap->mac_version);
+	hdr.mac_rev = htole16(snap->mac_rev);
+	hdr.start = htole32(snap->start);
+	hdr.count = htole32(snap->count);
+	if (fwrite(&hdr, sizeof(hdr), 1, fp) != 1)
+		goto err;
+
+	for (i = 0; i < snap->nskips; ++i) {
+		skip.start = htole32(snap->skips[i].start);
+		skip.end = htole32(snap->skips[i].end);
+		if (fwrite(&skip, sizeof(skip), 1, fp) != 1)
+			goto err;
+	}
+
+	for (i = 0; i < snap->count; ++i) {
+		val = htole32(snap->regs[i]);
+		if (fwrite(&val, sizeof(val), 1, fp) != 1)
+			goto err;
+	}
+
+	if (fclose(fp) != 0) {
+		fprintf(stderr, "Unable to save snapshot: %s\n", strerror(errno));
+		return -EIO;
+	}
+
+	return 0;
+
+err:
+	fprintf(stderr, "Unable to write snapshot: %s\n", strerror(errno));
+	fclose(fp);
+
+	return -EIO;
+}
+
+static int regsnap_load(const char *fname, struct regsnap *snap)
+{
+	struct regsnap_hdr hdr;
+	struct regsnap_skip skip;
+	uint32_t i;
+	FILE *fp;
+
+	fp = fopen(fname, "rb");
+	if (!fp) {
+		fprintf(stderr, "Unable to open snapshot file '%s': %s\n", fname,
+			strerror(errno));
+		return -errno;
+	}
+
+	if (fread(&hdr, sizeof(hdr), 1, fp) != 1 ||
+	    memcmp(hdr.magic, REGSNAP_MAGIC, REGSNAP_MAGIC_LEN) != 0 ||
+	    hdr.version != REGSNAP_VERSION ||
+	    le16toh(hdr.nskips) > REGSNAP_SKIPS_MAX) {
+		fprintf(stderr, "File '%s' is not a registers snapshot\n",
+			fname);
+		goto err;
+	}
+
+	snap->mac_version = le32toh(hdr.mac_version);
+	snap->mac_rev = le16toh(hdr.mac_rev);
+	snap->start = le32toh(hdr.start);
+	snap->count = le32toh(hdr.count);
+	snap->nskips = le16toh(hdr.nskips);
+
+	for (i = 0; i < snap->nskips; ++i) {
+		if (fread(&skip, sizeof(skip), 1, fp) != 1)
+			goto err_trunc;
+		snap->skips[i].start = le32toh(skip.start);
+		snap->skips[i].end = le32toh(skip.end);
+	}
+
+	snap->regs = malloc((snap->count ? snap->count : 1) * sizeof(uint32_t));
+	if (!snap->regs) {
+		fprintf(stderr, "Unable to allocate memory for registers snapshot\n");
+		fclose(fp);
+		return -ENOMEM;
+	}
+	if (fread(snap->regs, sizeof(uint32_t), snap->count, fp) != snap->count) {
+		free(snap->regs);
+		goto err_trunc;
+	}
+	for (i = 0; i < snap->count; ++i)
+		snap->regs[i] = le32toh(snap->regs[i]);
+
+	fclose(fp);
+
+	return 0;
+
+err_trunc:
+	fprintf(stderr, "Snapshot file '%s' is truncated\n", fname);
+err:
+	fclose(fp);
+
+	return -EINVAL;
+}
+
+static bool regsnap_get(const struct regsnap *snap, uint32_t addr,
+			uint32_t *val)
+{
+	if (addr < snap->start || (addr - snap->start) / 4 >= snap->count ||
+	    regsnap_is_skipped(snap, addr))
+		return false;
+
+	*val = snap->regs[(addr - snap->start) / 4];
+
+	return true;
+}
+
+static bool regdump_parse_addr(const char *str, unsigned long *addr)
+{
+	char *endp;
+
+	errno = 0;
+	*addr = strtoul(str, &endp, 16);
+
+	return errno == 0 && *endp == '\0' && *addr % 4 == 0;
+}
+
+int act_reg_dump(struct atheepmgr *aem, int argc, char *argv[])
+{
+	struct regsnap snap;
+	unsigned long start, end;
+	int ret;
+
+	if (argc == 2 && strcasecmp(argv[0], "all") == 0) {
+		if (!aem->io_size) {
+			fprintf(stderr, "Registers space size is unknown, specify the range explicitly\n");
+			return -EINVAL;
+		}
+		start = 0;
+		end = aem->io_size;
+		argv++;
+	} else if (argc == 3) {
+		if (!regdump_parse_addr(argv[0], &start)) {
+			fprintf(stderr, "Invalid range start address -- %s\n",
+				argv[0]);
+			return -EINVAL;
+		}
+		if (!regdump_parse_addr(argv[1], &end) || end <= start) {
+			fprintf(stderr, "Invalid range end address -- %s\n",
+				argv[1]);
+			return -EINVAL;
+		}
+		argv += 2;
+	} else {
+		fprintf(stderr, "Registers range and output file should be specified, aborting\n");
+		return -EINVAL;
+	}
+
+	if (aem->io_size && end > aem->io_size) {
+		fprintf(stderr, "Range end 0x%08lx is beyond the mapped registers space size 0x%08lx\n",
+			end, (unsigned long)aem->io_size);
+		return -EINVAL;
+	}
+
+	ret = regsnap_read(aem, &snap, start, end);
+	if (ret)
+		return ret;
+
+	ret = regsnap_save(&snap, argv[0]);
+	if (ret == 0)
+		printf("Saved %u registers 0x%08lx-0x%08lx to %s\n", snap.count,
+		       start, end - 4, argv[0]);
+
+	free(snap.regs);
+
+	return ret;
+}
+
+int act_reg_diff(struct atheepmgr *aem, int argc, char *argv[])
+{
+	struct regsnap a, b;
+	uint32_t i, addr, va, vb;
+	int ndiff = 0, ret;
+
+	if (argc < 1) {
+		fprintf(stderr, "Registers snapshot file is not specified, aborting\n");
+		return -EINVAL;
+	}
+
+	ret = regsnap_load(argv[0], &a);
+	if (ret)
+		return ret;
+
+	if (argc >= 2) {
+		ret = regsnap_load(argv[1], &b);
+		if (ret)
+			goto exit_a;
+	} else {
+		/* Compare with the live device */
+		if (!aem->con || !(aem->con->caps & CON_CAP_HW)) {
+			fprintf(stderr, "Connector with direct HW access is required for comparing with the device\n");
+			ret = -EINVAL;
+			goto exit_a;
+		}
+		ret = aem_attach(aem, ACT_F_HW);
+		if (ret)
+			goto exit_a;
+		if (aem->io_size && a.start + a.count * 4 > aem->io_size) {
+			fprintf(stderr, "Snapshot is beyond the mapped registers space\n");
+			ret = -EINVAL;
+		} else {
+			ret = regsnap_read(aem, &b, a.start, a.start + a.count * 4);
+		}
+		aem_detach(aem);
+		if (ret)
+			goto exit_a;
+	}
+
+	if (a.mac_version != b.mac_version || a.mac_rev != b.mac_rev)
+		printf("NB: snapshots are taken from different chips (0x%04x:0x%x and 0x%04x:0x%x)\n",
+		       a.mac_version, a.mac_rev, b.mac_version, b.mac_rev);
+
+	for (i = 0, addr = a.start; i < a.count; ++i, addr += 4) {
+		if (regsnap_is_skipped(&a, addr) || !regsnap_get(&b, addr, &vb))
+			continue;
+		va = a.regs[i];
+		if (va == vb)
+			continue;
+		printf("0x%08x: 0x%08x -> 0x%08x (changed 0x%08x)\n", addr, va,
+		       vb, va ^ vb);
+		ndiff++;
+	}
+
+	printf("%d register(s) differ\n", ndiff);
+
+	free(b.regs);
+exit_a:
+	free(a.regs);
+
+	return ret;
+}
@@ -0,0 +1,413 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <ctype.h>
+#include <time.h>
+
+#include "atheepmgr.h"
+
+/**
+ * Register script is a text, one operation per line:
+ *
+ *   read <addr> [<var>]              - read register to var or print it
+ *   write <addr> <val>               - write register
+ *   rmw <addr> <set> <clr>           - modify register bits
+ *   wait <addr> <mask> <val> [<ms>]  - wait for (reg & mask) == val
+ *   sleep <ms>                       - delay
+ *   set <var> <a> [<op> <b>]         - assign var, op: & | ^ + - << >>
+ *   print <text or arg>...           - print text and values
+ *
+ * Arguments are C notation numbers or $<name> variables. Text after '#'
+ * is a comment. The whole script is parsed before the first register
+ * access, so a syntax error does not leave the device half-configured.
+ */
+
+#define RS_VARS_MAX		64
+#define RS_VAR_NAME_LEN		32
+#define RS_ARGS_MAX		4
+#define RS_WAIT_TIMEOUT		1000	/* Default wait timeout, ms */
+
+enum rs_op_type {
+	RS_OP_READ,
+	RS_OP_WRITE,
+	RS_OP_RMW,
+	RS_OP_WAIT,
+	RS_OP_SLEEP,
+	RS_OP_SET,
+	RS_OP_PRINT,
+};
+
+enum rs_alu_op {
+	RS_ALU_NONE,
+	RS_ALU_AND,
+	RS_ALU_OR,
+	RS_ALU_XOR,
+	RS_ALU_ADD,
+	RS_ALU_SUB,
+	RS_ALU_SHL,
+	RS_ALU_SHR,
+};
+
+struct rs_arg {
+	int var;			/* Variable index or -1 for literal */
+	uint32_t val;
+};
+
+struct rs_op {
+	enum rs_op_type type;
+	int line;
+	int nargs;
+	struct rs_arg args[RS_ARGS_MAX];
+	int dst;			/* Destination variable or -1 */
+	enum rs_alu_op alu;
+	char *text;			/* Print operation format */
+};
+
+struct rs_ctx {
+	const char *fname;
+	struct rs_op *ops;
+	int nops;
+	int nvars;
+	char names[RS_VARS_MAX][RS_VAR_NAME_LEN];
+	uint32_t vars[RS_VARS_MAX];
+};
+
+static const struct {
+	const char *name;
+	enum rs_op_type type;
+	int min_args;
+	int max_args;
+} rs_op_list[] = {
+	{"read", RS_OP_READ, 1, 2},
+	{"write", RS_OP_WRITE, 2, 2},
+	{"rmw", RS_OP_RMW, 3, 3},
+	{"wait", RS_OP_WAIT, 3, 4},
+	{"sleep", RS_OP_SLEEP, 1, 1},
+	{"set", RS_OP_SET, 2, 4},
+	{"print", RS_OP_PRINT, 0, 0},
+};
+
+static const char * const rs_alu_list[] = {
+	[RS_ALU_AND] = "&",
+	[RS_ALU_OR] = "|",
+	[RS_ALU_XOR] = "^",
+	[RS_ALU_ADD] = "+",
+	[RS_ALU_SUB] = "-",
+	[RS_ALU_SHL] = "<<",
+	[RS_ALU_SHR] = ">>",
+};
+
+static int rs_var_lookup(struct rs_ctx *ctx, const char *name, bool create)
+{
+	int i;
+
+	for (i = 0; i < ctx->nvars; ++i)
+		if (strcmp(ctx->names[i], name) == 0)
+			return i;
+
+	if (!create || ctx->nvars == RS_VARS_MAX ||
+	    strlen(name) >= RS_VAR_NAME_LEN)
+		return -1;
+
+	strcpy(ctx->names[ctx->nvars], name);
+	ctx->vars[ctx->nvars] = 0;
+
+	return ctx->nvars++;
+}
+
+static bool rs_parse_arg(struct rs_ctx *ctx, const char *str,
+			 struct rs_arg *arg)
+{
+	char *endp;
+
+	if (str[0] == '$') {
+		arg->var = rs_var_lookup(ctx, str + 1, false);
+		return arg->var >= 0;
+	}
+
+	errno = 0;
+	arg->var = -1;
+	arg->val = strtoul(str, &endp, 0);
+
+	return errno == 0 && *endp == '\0' && endp != str;
+}
+
+static int rs_parse_line(struct rs_ctx *ctx, char *line, int lnum,
+			 struct rs_op *op)
+{
+	char *tok[RS_ARGS_MAX + 2], *p;
+	int i, ntok = 0;
+
+	p = strchr(line, '#');
+	if (p)
+		*p = '\0';
+
+	memset(op, 0x00, sizeof(*op));
+	op->line = lnum;
+	op->dst = -1;
+
+	p = strtok(line, " \t\r\n");
+	if (!p)
+		return 0;	/* Empty line */
+
+	for (i = 0; i < ARRAY_SIZE(rs_op_list); ++i)
+		if (strcasecmp(p, rs_op_list[i].name) == 0)
+			break;
+	if (i == ARRAY_SIZE(rs_op_list)) {
+		fprintf(stderr, "%s:%d: unknown operation -- %s\n", ctx->fname,
+			lnum, p);
+		return -EINVAL;
+	}
+	op->type = rs_op_list[i].type;
+
+	if (op->type == RS_OP_PRINT) {
+		p = strtok(NULL, "\r\n");
+		op->text = strdup(p ? p : "");
+		return op->text ? 1 : -ENOMEM;
+	}
+
+	while ((p = strtok(NULL, " \t\r\n")) != NULL && ntok < ARRAY_SIZE(tok))
+		tok[ntok++] = p;
+	if (p || ntok < rs_op_list[i].min_args ||
+	    ntok > rs_op_list[i].max_args || (op->type == RS_OP_SET && ntok == 3)) {
+		fprintf(stderr, "%s:%d: invalid number of %s arguments\n",
+			ctx->fname, lnum, rs_op_list[i].name);
+		return -EINVAL;
+	}
+
+	/* Destination variable is created on the first assignment */
+	if (op->type == RS_OP_READ && ntok == 2) {
+		op->dst = rs_var_lookup(ctx, tok[1] + (tok[1][0] == '$'), true);
+		if (op->dst < 0)
+			goto err_var;
+		ntok = 1;
+	} else if (op->type == RS_OP_SET) {
+		op->dst = rs_var_lookup(ctx, tok[0] + (tok[0][0] == '$'), true);
+		if (op->dst < 0)
+			goto err_var;
+		if (ntok == 4) {
+			for (op->alu = RS_ALU_AND; op->alu <= RS_ALU_SHR; op->alu++)
+				if (strcmp(tok[2], rs_alu_list[op->alu]) == 0)
+					break;
+			if (op->alu > RS_ALU_SHR) {
+				fprintf(stderr, "%s:%d: unknown operator -- %s\n",
+					ctx->fname, lnum, tok[2]);
+				return -EINVAL;
+			}
+			tok[2] = tok[3];
+			ntok = 3;
+		}
+		memmove(&tok[0], &tok[1], --ntok * sizeof(tok[0]));
+	}
+	for (i = 0; i < ntok; ++i) {
+		if (!rs_parse_arg(ctx, tok[i], &op->args[i])) {
+			fprintf(stderr, "%s:%d: invalid argument -- %s\n",
+				ctx->fname, lnum, tok[i]);
+			return -EINVAL;
+		}
+	}
+	op->nargs = ntok;
+
+	if (op->type == RS_OP_WAIT && op->nargs == 3) {
+		op->args[3].var = -1;
+		op->args[3].val = RS_WAIT_TIMEOUT;
+		op->nargs = 4;
+	}
+
+	if (op->type == RS_OP_READ || op->type == RS_OP_WRITE ||
+	    op->type == RS_OP_RMW || op->type == RS_OP_WAIT) {
+		if (op->args[0].var < 0 && op->args[0].val % 4 != 0) {
+			fprintf(stderr, "%s:%d: unaligned register address 0x%08x\n",
+				ctx->fname, lnum, op->args[0].val);
+			return -EINVAL;
+		}
+	}
+
+	return 1;
+
+err_var:
+	fprintf(stderr, "%s:%d: invalid variable name or too many variables\n",
+		ctx->fname, lnum);
+
+	return -EINVAL;
+}
+
+static int rs_load(struct rs_ctx *ctx, FILE *fp)
+{
+	char line[0x200];
+	struct rs_op *ops;
+	int lnum = 0, sz = 0, ret;
+
+	while (fgets(line, sizeof(line), fp)) {
+		lnum++;
+		if (ctx->nops == sz) {
+			sz = sz ? sz * 2 : 64;
+			ops = realloc(ctx->ops, sz * sizeof(ctx->ops[0]));
+			if (!ops) {
+				fprintf(stderr, "Unable to allocate memory for script\n");
+				return -ENOMEM;
+			}
+			ctx->ops = ops;
+		}
+		ret = rs_parse_line(ctx, line, lnum, &ctx->ops[ctx->nops]);
+		if (ret < 0)
+			return ret;
+		ctx->nops += ret;
+	}
+
+	return 0;
+}
+
+static inline uint32_t rs_arg_val(const struct rs_ctx *ctx,
+				  const struct rs_arg *arg)
+{
+	return arg->var < 0 ? arg->val : ctx->vars[arg->var];
+}
+
+static uint64_t rs_time_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void rs_print(const struct rs_ctx *ctx, const char *text)
+{
+	const char *p, *e;
+	char name[RS_VAR_NAME_LEN];
+	int i;
+
+	for (p = text; *p; p = e) {
+		if (*p != '$') {
+			e = p + 1;
+			putchar(*p);
+			continue;
+		}
+		for (e = p + 1; isalnum((unsigned char)*e) || *e == '_'; ++e);
+		i = -1;
+		if (e - p - 1 < RS_VAR_NAME_LEN) {
+			memcpy(name, p + 1, e - p - 1);
+			name[e - p - 1] = '\0';
+			for (i = 0; i < ctx->nvars; ++i)
+				if (strcmp(ctx->names[i], name) == 0)
+					break;
+		}
+		if (i >= 0 && i < ctx->nvars)
+			printf("0x%08x", ctx->vars[i]);
+		else
+			fwrite(p, 1, e - p, stdout);
+	}
+	putchar('\n');
+}
+
+static int rs_exec(struct atheepmgr *aem, struct rs_ctx *ctx)
+{
+	const struct rs_op *op;
+	uint32_t addr, a, b, val;
+	uint64_t deadline;
+	int i;
+
+	for (i = 0; i < ctx->nops; ++i) {
+		op = &ctx->ops[i];
+		addr = rs_arg_val(ctx, &op->args[0]);
+		switch (op->type) {
+		case RS_OP_READ:
+			val = REG_READ(addr);
+			if (op->dst >= 0)
+				ctx->vars[op->dst] = val;
+			else
+				printf("0x%08x: 0x%08x\n", addr, val);
+			break;
+		case RS_OP_WRITE:
+			REG_WRITE(addr, rs_arg_val(ctx, &op->args[1]));
+			break;
+		case RS_OP_RMW:
+			REG_RMW(addr, rs_arg_val(ctx, &op->args[1]),
+				rs_arg_val(ctx, &op->args[2]));
+			break;
+		case RS_OP_WAIT:
+			a = rs_arg_val(ctx, &op->args[1]);
+			b = rs_arg_val(ctx, &op->args[2]);
+			deadline = rs_time_ms() + rs_arg_val(ctx, &op->args[3]);
+			while (((val = REG_READ(addr)) & a) != b) {
+				if (rs_time_ms() > deadline) {
+					fprintf(stderr, "%s:%d: timeout waiting for 0x%08x & 0x%08x == 0x%08x (last 0x%08x)\n",
+						ctx->fname, op->line, addr, a,
+						b, val);
+					return -ETIMEDOUT;
+				}
+				usleep(10);
+			}
+			break;
+		case RS_OP_SLEEP:
+			usleep(addr * 1000);
+			break;
+		case RS_OP_SET:
+			a = addr;
+			b = op->nargs > 1 ? rs_arg_val(ctx, &op->args[1]) : 0;
+			switch (op->alu) {
+			case RS_ALU_NONE: val = a; break;
+			case RS_ALU_AND: val = a & b; break;
+			case RS_ALU_OR: val = a | b; break;
+			case RS_ALU_XOR: val = a ^ b; break;
+			case RS_ALU_ADD: val = a + b; break;
+			case RS_ALU_SUB: val = a - b; break;
+			case RS_ALU_SHL: val = b < 32 ? a << b : 0; break;
+			case RS_ALU_SHR: val = b < 32 ? a >> b : 0; break;
+			default: val = 0;
+			}
+			ctx->vars[op->dst] = val;
+			break;
+		case RS_OP_PRINT:
+			rs_print(ctx, op->text);
+			break;
+		}
+	}
+
+	return 0;
+}
+
+int act_reg_script(struct atheepmgr *aem, int argc, char *argv[])
+{
+	struct rs_ctx __ctx = {0}, *ctx = &__ctx;
+	FILE *fp = stdin;
+	int i, ret;
+
+	if (argc >= 1 && strcmp(argv[0], "-") != 0) {
+		fp = fopen(argv[0], "r");
+		if (!fp) {
+			fprintf(stderr, "Unable to open script file '%s': %s\n",
+				argv[0], strerror(errno));
+			return -errno;
+		}
+	}
+	ctx->fname = fp == stdin ? "<stdin>" : argv[0];
+
+	ret = rs_load(ctx, fp);
+	if (fp != stdin)
+		fclose(fp);
+
+	if (ret == 0)
+		ret = rs_exec(aem, ctx);
+
+	for (i = 0; i < ctx->nops; ++i)
+		free(ctx->ops[i].text);
+	free(ctx->ops);
+
+	return ret;
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "atheepmgr.h"
+#include "container.h"
+
+#define RESTORE_RESUME_SUFFIX	".resume"
+#define RESTORE_RESUME_STEP	32	/* Resume point update step, words */
+#define RESTORE_WRITE_RETRIES	3
+
+static size_t restore_resume_load(const char *fname, uint64_t hash)
+{
+	unsigned long long rhash;
+	unsigned long pos;
+	FILE *fp;
+	int res;
+
+	fp = fopen(fname, "r");
+	if (!fp)
+		return 0;
+	res = fscanf(fp, "%llx %lu", &rhash, &pos);
+	fclose(fp);
+
+	return res == 2 && rhash == hash ? pos : 0;
+}
+
+static void restore_resume_save(const char *fname, uint64_t hash, size_t pos)
+{
+	FILE *fp;
+
+	fp = fopen(fname, "w");
+	if (!fp)
+		return;
+	fprintf(fp, "%016llx %lu\n", (unsigned long long)hash,
+		(unsigned long)pos);
+	fclose(fp);
+}
+
+static void restore_progress(size_t pos, size_t len, int nwritten)
+{
+	printf("\rRestoring: %3u%% (%zu of %zu words checked, %d written)",
+	       (unsigned)(pos * 100 / len), pos, len, nwritten);
+	fflush(stdout);
+}
+
+static bool restore_word(struct atheepmgr *aem, uint32_t addr, uint16_t val)
+{
+	uint16_t word;
+	int i;
+
+	for (i = 0; i < RESTORE_WRITE_RETRIES; ++i) {
+		if (!EEP_WRITE(addr, val))
+			continue;
+		if (EEP_READ(addr, &word) && word == val)
+			return true;
+	}
+
+	return false;
+}
+
+int act_eep_restore(struct atheepmgr *aem, int argc, char *argv[])
+{
+	char resume[0x200];
+	struct cont_info info;
+	uint16_t *buf, word;
+	size_t len, pos, start;
+	int nwritten = 0, ret = 0;
+	uint64_t hash;
+
+	if (argc < 1) {
+		fprintf(stderr, "Image file for EEPROM restoring is not specified, aborting\n");
+		return -EINVAL;
+	}
+
+	ret = cont_load_image(argv[0], &info, &buf, &len);
+	if (ret)
+		return ret;
+	hash = cont_hash(buf, len);
+
+	if (info.eepmap)
+		aem->eep_io_swap = info.io_swap;
+	else
+		eep_detect_io_swap(aem, buf, len);
+
+	snprintf(resume, sizeof(resume), "%s" RESTORE_RESUME_SUFFIX, argv[0]);
+	start = restore_resume_load(resume, hash);
+	if (start >= len)
+		start = 0;
+	if (start)
+		printf("Resume EEPROM restoring from 0x%04zx\n", start);
+
+	EEP_UNLOCK();
+
+	for (pos = start; pos < len; ++pos) {
+		if (pos % RESTORE_RESUME_STEP == 0) {
+			restore_resume_save(resume, hash, pos);
+			if (isatty(STDOUT_FILENO))
+				restore_progress(pos, len, nwritten);
+		}
+		if (!EEP_READ(pos, &word)) {
+			fprintf(stderr, "\nUnable to read EEPROM at 0x%04zx\n",
+				pos);
+			ret = -EIO;
+			break;
+		}
+		if (word == buf[pos])	/* Write only changed words */
+			continue;
+		if (!restore_word(aem, pos, buf[pos])) {
+			fprintf(stderr, "\nUnable to write EEPROM at 0x%04zx\n",
+				pos);
+			ret = -EIO;
+			break;
+		}
+		nwritten++;
+	}
+
+	EEP_LOCK();
+
+	if (ret) {
+		printf("Restoring interrupted, rerun the action to resume it\n");
+		goto exit;
+	}
+
+	restore_progress(len, len, nwritten);
+	printf("\n");
+
+	/* Final read back of the whole image, since a part could be skipped */
+	for (pos = 0; pos < len; ++pos) {
+		if (!EEP_READ(pos, &word) || word != buf[pos]) {
+			fprintf(stderr, "Verification failed at 0x%04zx\n",
+				pos);
+			unlink(resume);
+			ret = -EIO;
+			goto exit;
+		}
+	}
+
+	unlink(resume);
+	printf("EEPROM successfully restored and verified\n");
+
+exit:
+	free(buf);
+
+	return ret;
+}
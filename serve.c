@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "atheepmgr.h"
+#include "hw.h"
+#include "utils.h"
+
+/**
+ * Daemon protocol: a client connects to the Unix socket, sends a single
+ * request line and receives the textual response until the connection is
+ * closed. A request is either any action (e.g. 'dump base' or 'gpiodump'),
+ * which is executed against the EEPROM data fetched at the daemon start, or
+ * one of the daemon own queries:
+ *
+ *   raw <off> [<count>]  - EEPROM words from the fetched image
+ *   get <field>          - single field: chip, srev, map, mac, len or check
+ *   refresh              - fetch the EEPROM data again
+ *
+ * The stdout and stderr of the action are redirected to the client socket,
+ * so the daemon replies exactly as the utility would do. Actions, which access
+ * files by a path (e.g. save or metrics), are not served, since the daemon
+ * usually runs as root. The socket is accessible only by the daemon owner
+ * unless the mode=<mode> option is specified.
+ */
+
+#define SRV_REQ_MAX		0x400	/* Max request length */
+#define SRV_ARGS_MAX		16	/* Max request arguments */
+#define SRV_RECV_TIMEOUT	1	/* Request receiving timeout, s */
+#define SRV_SEND_TIMEOUT	5	/* Reply sending timeout, s */
+#define SRV_MODE_DEF		0600	/* Default socket access mode */
+
+static volatile sig_atomic_t srv_stop;
+
+static void srv_sig_handler(int sig)
+{
+	srv_stop = 1;
+}
+
+static int srv_raw(struct atheepmgr *aem, int argc, char *argv[])
+{
+	unsigned long off, cnt = 1, i;
+	char *endp;
+
+	if (argc < 1) {
+		fprintf(stderr, "EEPROM offset is not specified\n");
+		return -EINVAL;
+	}
+	errno = 0;
+	off = strtoul(argv[0], &endp, 0);
+	if (errno || *endp != '\0') {
+		fprintf(stderr, "Invalid EEPROM offset -- %s\n", argv[0]);
+		return -EINVAL;
+	}
+	if (argc > 1) {
+		cnt = strtoul(argv[1], &endp, 0);
+		if (errno || *endp != '\0') {
+			fprintf(stderr, "Invalid words number -- %s\n", argv[1]);
+			return -EINVAL;
+		}
+	}
+	if (off >= aem->eep_len || cnt > aem->eep_len - off) {
+		fprintf(stderr, "Words range is out of EEPROM data (0x%04zx words)\n",
+			aem->eep_len);
+		return -ERANGE;
+	}
+
+	for (i = 0; i < cnt; ++i) {
+		if (i % 8 == 0)
+			printf("%s%04lx:", i ? "\n" : "", off + i);
+		printf(" %04x", aem->eep_buf[off + i]);
+	}
+	printf("\n");
+
+	return 0;
+}
+
+static int srv_get(struct atheepmgr *aem, int argc, char *argv[])
+{
+	uint8_t mac[6];
+
+	if (argc < 1) {
+		fprintf(stderr, "Field name is not specified\n");
+		return -EINVAL;
+	}
+
+	if (strcasecmp(argv[0], "chip") == 0 && aem->chip) {
+		printf("%s\n", aem->chip->name);
+	} else if (strcasecmp(argv[0], "srev") == 0 && aem->chip) {
+		printf("0x%x/0x%x\n", aem->macVersion, aem->macRev);
+	} else if (strcasecmp(argv[0], "map") == 0) {
+		printf("%s\n", aem->eepmap->name);
+	} else if (strcasecmp(argv[0], "mac") == 0 &&
+		   aem->eepmap->get_macaddr) {
+		aem->eepmap->get_macaddr(aem, mac);
+		printf("%02x:%02x:%02x:%02x:%02x:%02x\n", mac[0], mac[1],
+		       mac[2], mac[3], mac[4], mac[5]);
+	} else if (strcasecmp(argv[0], "len") == 0) {
+		printf("%zu\n", aem->eep_len);
+	} else if (strcasecmp(argv[0], "check") == 0) {
+		/* NB: check could byteswap the parsed data, so use the cached result */
+		printf("%s\n", aem->eep_check ? "ok" : "bad");
+	} else {
+		fprintf(stderr, "Unknown or unsupported field -- %s\n", argv[0]);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int srv_handle(struct atheepmgr *aem, char *req, bool rw)
+{
+	char *argv[SRV_ARGS_MAX], *tok;
+	int argc = 0, ret;
+
+	for (tok = strtok(req, " \t\r\n"); tok && argc < SRV_ARGS_MAX;
+	     tok = strtok(NULL, " \t\r\n"))
+		argv[argc++] = tok;
+	if (!argc) {
+		fprintf(stderr, "Empty request\n");
+		return -EINVAL;
+	}
+
+	if (strcasecmp(argv[0], "raw") == 0)
+		return srv_raw(aem, argc - 1, argv + 1);
+	if (strcasecmp(argv[0], "get") == 0)
+		return srv_get(aem, argc - 1, argv + 1);
+	if (strcasecmp(argv[0], "refresh") == 0) {
+		ret = aem_refill(aem, false);
+		if (ret == 0 || ret == -EINVAL)	/* Serve data even if check failed */
+			printf("EEPROM data refreshed, %zu words, check %s\n",
+			       aem->eep_len, aem->eep_check ? "ok" : "bad");
+		return ret;
+	}
+
+	return aem_act_run(aem, argc, argv, rw);
+}
+
+static void srv_client(struct atheepmgr *aem, int cfd, bool rw)
+{
+	struct timeval tv = {.tv_sec = SRV_RECV_TIMEOUT};
+	struct timeval stv = {.tv_sec = SRV_SEND_TIMEOUT};
+	char req[SRV_REQ_MAX + 1];
+	int sout, serr;
+	size_t len = 0;
+	ssize_t res;
+
+	setsockopt(cfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+	/* Do not let a stuck client block the daemon for other clients */
+	setsockopt(cfd, SOL_SOCKET, SO_SNDTIMEO, &stv, sizeof(stv));
+	while (len < SRV_REQ_MAX && !memchr(req, '\n', len)) {
+		res = recv(cfd, req + len, SRV_REQ_MAX - len, 0);
+		if (res <= 0)
+			break;
+		len += res;
+	}
+	req[len] = '\0';
+	if (!len)
+		return;
+
+	/* Reply exactly as the utility prints to the terminal */
+	fflush(stdout);
+	fflush(stderr);
+	sout = dup(STDOUT_FILENO);
+	serr = dup(STDERR_FILENO);
+	dup2(cfd, STDOUT_FILENO);
+	dup2(cfd, STDERR_FILENO);
+
+	srv_handle(aem, req, rw);
+
+	fflush(stdout);
+	fflush(stderr);
+	dup2(sout, STDOUT_FILENO);
+	dup2(serr, STDERR_FILENO);
+	close(sout);
+	close(serr);
+}
+
+int act_eep_serve(struct atheepmgr *aem, int argc, char *argv[])
+{
+	struct sockaddr_un addr = {.sun_family = AF_UNIX};
+	struct sigaction sa = {.sa_handler = srv_sig_handler};
+	unsigned long nreqs = 0, mode = SRV_MODE_DEF;
+	bool rw = false;
+	int sfd, cfd, i, ret;
+	mode_t umask_old;
+
+	if (argc < 1) {
+		fprintf(stderr, "Socket path is not specified, aborting\n");
+		return -EINVAL;
+	}
+	if (strlen(argv[0]) >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "Socket path is too long -- %s\n", argv[0]);
+		return -EINVAL;
+	}
+	for (i = 1; i < argc; ++i) {
+		if (strcasecmp(argv[i], "rw") == 0) {
+			rw = true;
+		} else if (parse_opt_ulong(argv[i], "mode", &mode)) {
+			if (mode & ~0777UL) {
+				fprintf(stderr, "Invalid socket mode -- %s\n",
+					argv[i]);
+				return -EINVAL;
+			}
+		} else {
+			fprintf(stderr, "Invalid serving option -- %s\n",
+				argv[i]);
+			return -EINVAL;
+		}
+	}
+	strcpy(addr.sun_path, argv[0]);
+
+	sfd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sfd < 0) {
+		fprintf(stderr, "Unable to create socket: %s\n",
+			strerror(errno));
+		return -errno;
+	}
+	unlink(addr.sun_path);		/* Remove a stale socket */
+	umask_old = umask(0177);	/* No access until chmod() */
+	ret = bind(sfd, (struct sockaddr *)&addr, sizeof(addr));
+	umask(umask_old);
+	if (ret != 0 || chmod(addr.sun_path, mode) != 0 ||
+	    listen(sfd, 8) != 0) {
+		ret = -errno;
+		fprintf(stderr, "Unable to listen on %s: %s\n", addr.sun_path,
+			strerror(errno));
+		close(sfd);
+		return ret;
+	}
+
+	/* NB: no SA_RESTART, so accept() is interrupted by the signal */
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	signal(SIGPIPE, SIG_IGN);	/* Client could disconnect at any time */
+
+	printf("Serving %s EEPROM data (%zu words) on %s%s\n",
+	       aem->eepmap->name, aem->eep_len, addr.sun_path,
+	       rw ? ", updates are allowed" : "");
+	fflush(stdout);
+
+	while (!srv_stop) {
+		cfd = accept(sfd, NULL, NULL);
+		if (cfd < 0) {
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+			fprintf(stderr, "Unable to accept connection: %s\n",
+				strerror(errno));
+			break;
+		}
+		srv_client(aem, cfd, rw);
+		close(cfd);
+		nreqs++;
+	}
+
+	printf("Served %lu request(s)\n", nreqs);
+
+	signal(SIGINT, SIG_DFL);
+	signal(SIGTERM, SIG_DFL);
+	signal(SIGPIPE, SIG_DFL);
+	close(sfd);
+	unlink(addr.sun_path);
+
+	return 0;
+}
+
+int act_eep_query(struct atheepmgr *aem, int argc, char *argv[])
+{
+	struct sockaddr_un addr = {.sun_family = AF_UNIX};
+	char buf[0x1000];
+	ssize_t res;
+	int fd, i, ret;
+
+	if (argc < 2) {
+		fprintf(stderr, "Socket path and request should be specified, aborting\n");
+		return -EINVAL;
+	}
+	if (strlen(argv[0]) >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "Socket path is too long -- %s\n", argv[0]);
+		return -EINVAL;
+	}
+	strcpy(addr.sun_path, argv[0]);
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+		ret = -errno;
+		fprintf(stderr, "Unable to connect to %s: %s\n", addr.sun_path,
+			strerror(errno));
+		if (fd >= 0)
+			close(fd);
+		return ret;
+	}
+
+	for (i = 1; i < argc; ++i)
+		dprintf(fd, "%s%s", argv[i], i + 1 < argc ? " " : "\n");
+
+	while ((res = read(fd, buf, sizeof(buf))) > 0)
+		fwrite(buf, 1, res, stdout);
+
+	close(fd);
+
+	return 0;
+}
@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <time.h>
+
+#include "atheepmgr.h"
+#include "container.h"
+
+/**
+ * Dumps store directory layout:
+ *
+ *   <dir>/objects/<hh>/<hhhhhhhhhhhhhh>  - EEPROM content containers
+ *   <dir>/index                          - store log
+ *
+ * Each content is stored only once in the container file, which name is
+ * the content hash (the first two digits are used as the shard directory).
+ * Each store operation appends a line to the index file:
+ *
+ *   <time> <hash> <eepmap> <macVersion>:<macRev> <MAC> <connector> <slot>
+ */
+
+#define STORE_INDEX		"index"
+#define STORE_OBJECTS		"objects"
+
+struct store_entry {
+	unsigned long long time;
+	char hash[17];
+	char eepmap[9];
+	char srev[16];
+	char mac[18];
+	char con[16];
+	char slot[0x100];
+};
+
+static int store_mkdir(const char *path)
+{
+	if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+		fprintf(stderr, "Unable to create directory '%s': %s\n", path,
+			strerror(errno));
+		return -errno;
+	}
+
+	return 0;
+}
+
+static void store_obj_path(char *buf, size_t bufsz, const char *dir,
+			   const char *hash)
+{
+	snprintf(buf, bufsz, "%s/" STORE_OBJECTS "/%.2s/%s", dir, hash,
+		 hash + 2);
+}
+
+/* Check whether the existing object contains the same data */
+static int store_obj_check(const char *path, const uint16_t *data, size_t len)
+{
+	struct cont_info info;
+	uint16_t *buf;
+	size_t blen;
+	int ret;
+
+	ret = cont_load_image(path, &info, &buf, &blen);
+	if (ret)
+		return ret;
+
+	ret = blen == len && memcmp(buf, data, len * sizeof(uint16_t)) == 0;
+	free(buf);
+
+	return ret ? 0 : -EEXIST;
+}
+
+static bool store_entry_parse(const char *line, struct store_entry *ent)
+{
+	int res;
+
+	ent->slot[0] = '\0';
+	res = sscanf(line, "%llu %16s %8s %15s %17s %15s %255[^\n]",
+		     &ent->time, ent->hash, ent->eepmap, ent->srev, ent->mac,
+		     ent->con, ent->slot);
+
+	return res >= 6;
+}
+
+static bool store_entry_match(const struct store_entry *ent, const char *dev)
+{
+	if (!dev)
+		return true;
+
+	return strcasecmp(ent->mac, dev) == 0 || strcmp(ent->slot, dev) == 0 ||
+	       (strlen(dev) >= 4 &&
+		strncasecmp(ent->hash, dev, strlen(dev)) == 0);
+}
+
+int act_eep_store(struct atheepmgr *aem, int argc, char *argv[])
+{
+	const uint16_t *buf = aem->eep_buf;
+	size_t len = aem->eep_len;
+	char path[0x200], tmp[0x210], hash[17], mac_str[18];
+	uint8_t mac[6] = {0};
+	bool stored = false;
+	FILE *fp;
+	int ret;
+
+	if (!aem->eepmap->eep_buf_sz) {
+		fprintf(stderr, "EEPROM map does not support buffered operation, so the content storing is not possible\n");
+		return -EOPNOTSUPP;
+	}
+
+	if (argc < 1) {
+		fprintf(stderr, "Store directory is not specified, aborting\n");
+		return -EINVAL;
+	}
+
+	snprintf(hash, sizeof(hash), "%016llx",
+		 (unsigned long long)cont_hash(buf, len));
+
+	ret = store_mkdir(argv[0]);
+	if (ret)
+		return ret;
+	snprintf(path, sizeof(path), "%s/" STORE_OBJECTS, argv[0]);
+	ret = store_mkdir(path);
+	if (ret)
+		return ret;
+	snprintf(path, sizeof(path), "%s/" STORE_OBJECTS "/%.2s", argv[0],
+		 hash);
+	ret = store_mkdir(path);
+	if (ret)
+		return ret;
+
+	store_obj_path(path, sizeof(path), argv[0], hash);
+	if (access(path, F_OK) == 0) {
+		ret = store_obj_check(path, buf, len);
+		if (ret == -EEXIST)
+			fprintf(stderr, "Hash collision with object %s, aborting\n",
+				path);
+		if (ret)
+			return ret;
+	} else {
+		/* Write via a temporary file to avoid a partial object */
+		snprintf(tmp, sizeof(tmp), "%s.%d", path, (int)getpid());
+		ret = cont_save(aem, tmp);
+		if (ret)
+			return ret;
+		if (rename(tmp, path) != 0) {
+			fprintf(stderr, "Unable to save object %s: %s\n", path,
+				strerror(errno));
+			unlink(tmp);
+			return -errno;
+		}
+		stored = true;
+	}
+
+	if (aem->eepmap->get_macaddr)
+		aem->eepmap->get_macaddr(aem, mac);
+	snprintf(mac_str, sizeof(mac_str), "%02x:%02x:%02x:%02x:%02x:%02x",
+		 mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+
+	snprintf(path, sizeof(path), "%s/" STORE_INDEX, argv[0]);
+	fp = fopen(path, "a");
+	if (!fp) {
+		fprintf(stderr, "Unable to open store index: %s\n",
+			strerror(errno));
+		return -errno;
+	}
+	flock(fileno(fp), LOCK_EX);
+	fprintf(fp, "%llu %s %s 0x%04x:0x%x %s %s %s\n",
+		(unsigned long long)time(NULL), hash, aem->eepmap->name,
+		aem->macVersion, aem->macRev, mac_str, aem->con->name,
+		aem->con_arg ? aem->con_arg : "-");
+	ret = fflush(fp) == 0 ? 0 : -EIO;
+	fclose(fp);		/* NB: closing releases the lock */
+
+	if (ret) {
+		fprintf(stderr, "Unable to update store index\n");
+		return ret;
+	}
+
+	printf("%s %s (%s)\n", stored ? "Stored" : "Already stored", hash,
+	       mac_str);
+
+	return 0;
+}
+
+static FILE *store_index_open(const char *dir)
+{
+	char path[0x200];
+	FILE *fp;
+
+	snprintf(path, sizeof(path), "%s/" STORE_INDEX, dir);
+	fp = fopen(path, "r");
+	if (!fp)
+		fprintf(stderr, "Unable to open store index: %s\n",
+			strerror(errno));
+
+	return fp;
+}
+
+int act_eep_store_list(struct atheepmgr *aem, int argc, char *argv[])
+{
+	struct store_entry ent;
+	char line[0x200], tstr[0x20];
+	time_t t;
+	FILE *fp;
+
+	if (argc < 1) {
+		fprintf(stderr, "Store directory is not specified, aborting\n");
+		return -EINVAL;
+	}
+
+	fp = store_index_open(argv[0]);
+	if (!fp)
+		return -errno;
+
+	while (fgets(line, sizeof(line), fp)) {
+		if (!store_entry_parse(line, &ent))
+			continue;
+		if (!store_entry_match(&ent, argc > 1 ? argv[1] : NULL))
+			continue;
+		t = ent.time;
+		strftime(tstr, sizeof(tstr), "%Y-%m-%d %H:%M:%S",
+			 localtime(&t));
+		printf("%s  %s  %-4s  %-13s  %s  %s %s\n", tstr, ent.hash,
+		       ent.eepmap, ent.srev, ent.mac, ent.con, ent.slot);
+	}
+
+	fclose(fp);
+
+	return 0;
+}
+
+int act_eep_store_get(struct atheepmgr *aem, int argc, char *argv[])
+{
+	struct store_entry ent, last = {.hash = ""};
+	char line[0x200], path[0x200];
+	struct cont_info info;
+	uint16_t *buf;
+	size_t len;
+	FILE *fp;
+	int ret;
+
+	if (argc < 3) {
+		fprintf(stderr, "Store directory, device and output file should be specified, aborting\n");
+		return -EINVAL;
+	}
+
+	fp = store_index_open(argv[0]);
+	if (!fp)
+		return -errno;
+	while (fgets(line, sizeof(line), fp)) {
+		/* NB: index is sorted by time, so the last match wins */
+		if (store_entry_parse(line, &ent) &&
+		    store_entry_match(&ent, argv[1]))
+			last = ent;
+	}
+	fclose(fp);
+
+	if (last.hash[0] == '\0') {
+		fprintf(stderr, "No stored EEPROM for device %s\n", argv[1]);
+		return -ENOENT;
+	}
+
+	store_obj_path(path, sizeof(path), argv[0], last.hash);
+	ret = cont_load_image(path, &info, &buf, &len);
+	if (ret)
+		return ret;
+
+	fp = fopen(argv[2], "wb");
+	if (!fp) {
+		fprintf(stderr, "Unable to open output file for writing: %s\n",
+			strerror(errno));
+		free(buf);
+		return -errno;
+	}
+	if (fwrite(buf, sizeof(buf[0]), len, fp) != len) {
+		fprintf(stderr, "Unable to save EEPROM contents: %s\n",
+			strerror(errno));
+		ret = -EIO;
+	} else {
+		printf("Restored %s EEPROM %s (%s) to %s\n", last.eepmap,
+		       last.hash, last.mac, argv[2]);
+	}
+	fclose(fp);
+	free(buf);
+
+	return ret;
+}
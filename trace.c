@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "atheepmgr.h"
+#include "utils.h"
+#include "trace.h"
+
+/**
+ * Run timeline in the Chrome trace-event format (JSON array of events), which
+ * could be opened with chrome://tracing or Perfetto UI. Events are written as
+ * they happen, one per line, and the file is line buffered, so a trace of an
+ * interrupted run is still usable (the closing bracket is optional for the
+ * array format).
+ */
+
+#define TRACE_CHUNK_MAX		64	/* Max words in a traced reads chunk */
+
+static void trace_str(FILE *fp, const char *str)
+{
+	fputc('"', fp);
+	for (; *str; ++str) {
+		if (*str == '"' || *str == '\\')
+			fputc('\\', fp);
+		if ((unsigned char)*str >= 0x20)
+			fputc(*str, fp);
+	}
+	fputc('"', fp);
+}
+
+static void trace_event(struct atheepmgr *aem, const char *name, char ph)
+{
+	FILE *fp = aem->trace_fp;
+
+	fprintf(fp, ",{\"name\":");
+	trace_str(fp, name);
+	fprintf(fp, ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%d,\"tid\":%u", ph,
+		(time_mono_ns() - aem->trace_start) / 1e3, (int)getpid(),
+		aem->trace_tid);
+}
+
+static void trace_rd_flush(struct atheepmgr *aem)
+{
+	if (!aem->trace_rd_num)
+		return;
+
+	trace_event(aem, "eep_read", 'E');
+	fprintf(aem->trace_fp, ",\"args\":{\"words\":%u}}\n", aem->trace_rd_num);
+	aem->trace_rd_num = 0;
+}
+
+int trace_open(struct atheepmgr *aem, const char *path)
+{
+	aem->trace_fp = fopen(path, "w");
+	if (!aem->trace_fp) {
+		fprintf(stderr, "Unable to open trace file '%s': %s\n", path,
+			strerror(errno));
+		return -errno;
+	}
+
+	setvbuf(aem->trace_fp, NULL, _IOLBF, 0);
+
+	aem->trace_start = time_mono_ns();
+	aem->trace_tid = 0;
+	fprintf(aem->trace_fp, "[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"atheepmgr\"}}\n",
+		(int)getpid());
+	trace_track(aem, "main");
+
+	return 0;
+}
+
+void trace_close(struct atheepmgr *aem)
+{
+	if (!aem->trace_fp)
+		return;
+
+	trace_rd_flush(aem);
+	fprintf(aem->trace_fp, "]\n");
+	fclose(aem->trace_fp);
+	aem->trace_fp = NULL;
+}
+
+/* Switch to the next track (e.g. per batch target) */
+void trace_track(struct atheepmgr *aem, const char *name)
+{
+	if (!aem->trace_fp)
+		return;
+
+	aem->trace_tid++;
+	fprintf(aem->trace_fp, ",{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":",
+		(int)getpid(), aem->trace_tid);
+	trace_str(aem->trace_fp, name);
+	fprintf(aem->trace_fp, "}}\n");
+}
+
+void trace_begin(struct atheepmgr *aem, const char *name, const char *arg)
+{
+	if (!aem->trace_fp)
+		return;
+
+	trace_rd_flush(aem);
+	trace_event(aem, name, 'B');
+	if (arg) {
+		fprintf(aem->trace_fp, ",\"args\":{\"arg\":");
+		trace_str(aem->trace_fp, arg);
+		fputc('}', aem->trace_fp);
+	}
+	fprintf(aem->trace_fp, "}\n");
+}
+
+void trace_end(struct atheepmgr *aem, const char *name, int ret)
+{
+	if (!aem->trace_fp)
+		return;
+
+	trace_rd_flush(aem);
+	trace_event(aem, name, 'E');
+	fprintf(aem->trace_fp, ",\"args\":{\"ret\":%d}}\n", ret);
+}
+
+/**
+ * Group sequential (in any direction) EEPROM words reads into chunks to keep
+ * the trace compact while still showing the reading progress.
+ */
+void trace_eep_read(struct atheepmgr *aem, uint32_t off)
+{
+	if (aem->trace_rd_num && (aem->trace_rd_num >= TRACE_CHUNK_MAX ||
+	    (off != aem->trace_rd_last + 1 && off + 1 != aem->trace_rd_last)))
+		trace_rd_flush(aem);
+
+	if (!aem->trace_rd_num) {
+		trace_event(aem, "eep_read", 'B');
+		fprintf(aem->trace_fp, ",\"args\":{\"off\":%u}}\n", off);
+	}
+	aem->trace_rd_num++;
+	aem->trace_rd_last = off;
+}
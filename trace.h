@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+/**
+ * USDT (SDT) static tracepoints for bpftrace, perf, etc. A probe is a single
+ * nop instruction until a tracer attaches to it. Probes are compiled out if
+ * the sys/sdt.h header (systemtap-sdt-dev) is not available.
+ */
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define TRACE_USDT
+#endif
+#endif
+
+#ifdef TRACE_USDT
+#define TRACE_PROBE(_name)				\
+		DTRACE_PROBE(atheepmgr, _name)
+#define TRACE_PROBE1(_name, _a1)			\
+		DTRACE_PROBE1(atheepmgr, _name, _a1)
+#define TRACE_PROBE2(_name, _a1, _a2)			\
+		DTRACE_PROBE2(atheepmgr, _name, _a1, _a2)
+#define TRACE_PROBE3(_name, _a1, _a2, _a3)		\
+		DTRACE_PROBE3(atheepmgr, _name, _a1, _a2, _a3)
+#else
+#define TRACE_PROBE(_name)				do {} while (0)
+#define TRACE_PROBE1(_name, _a1)			do {} while (0)
+#define TRACE_PROBE2(_name, _a1, _a2)			do {} while (0)
+#define TRACE_PROBE3(_name, _a1, _a2, _a3)		do {} while (0)
+#endif
+
+struct atheepmgr;
+
+int trace_open(struct atheepmgr *aem, const char *path);
+void trace_close(struct atheepmgr *aem);
+void trace_track(struct atheepmgr *aem, const char *name);
+void trace_begin(struct atheepmgr *aem, const char *name, const char *arg);
+void trace_end(struct atheepmgr *aem, const char *name, int ret);
+void trace_eep_read(struct atheepmgr *aem, uint32_t off);
+
+#endif	/* TRACE_H */
@@ -15,7 +15,11 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
 
 #include "utils.h"
 
@@ -26,3 +30,51 @@ int macaddr_parse(const char *str, uint8_t *out)
 
 	return res == 6 ? 0 : -1;
 }
+
+/* See: http://www.isthe.com/chongo/tech/comp/fnv/index.html#FNV-1a */
+uint64_t fnv1a64(uint64_t hash, const void *data, size_t len)
+{
+	const uint8_t *p = data;
+
+	while (len--) {
+		hash ^= *p++;
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+/* Parse the action option in form <name>=<val>, returns 1 on success */
+int parse_opt_ulong(const char *str, const char *name, unsigned long *val)
+{
+	size_t len = strlen(name);
+	char *endp;
+
+	if (strncmp(str, name, len) != 0 || str[len] != '=')
+		return 0;
+
+	errno = 0;
+	*val = strtoul(str + len + 1, &endp, 0);
+
+	return errno == 0 && *endp == '\0';
+}
+
+/* Monotonic clock timestamp, ns */
+uint64_t time_mono_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Sleep up to the absolute monotonic clock timestamp */
+void sleep_until_ns(uint64_t ts)
+{
+	struct timespec tspec;
+
+	tspec.tv_sec = ts / 1000000000ULL;
+	tspec.tv_nsec = ts % 1000000000ULL;
+	clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &tspec, NULL);
+}
@@ -17,6 +17,7 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 static inline int macaddr_is_valid(const uint8_t *mac)
@@ -33,4 +34,13 @@ static inline int macaddr_is_valid(const uint8_t *mac)
 
 int macaddr_parse(const char *str, uint8_t *out);
 
+#define FNV1A64_INIT	0xcbf29ce484222325ULL
+
+uint64_t fnv1a64(uint64_t hash, const void *data, size_t len);
+
+int parse_opt_ulong(const char *str, const char *name, unsigned long *val);
+
+uint64_t time_mono_ns(void);
+void sleep_until_ns(uint64_t ts);
+
 #endif	/* UTILS_H */
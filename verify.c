@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "atheepmgr.h"
+#include "container.h"
+
+struct verify_ctx {
+	const uint16_t *ref;
+	size_t len;
+	uint8_t *checked;	/* Already checked words map */
+	bool all;		/* Do not stop on the first mismatch */
+	int nreads;
+	int nbad;
+};
+
+/* Returns false if the verification should be stopped */
+static bool verify_word(struct atheepmgr *aem, struct verify_ctx *ctx,
+			size_t off)
+{
+	uint16_t word;
+
+	if (off >= ctx->len || ctx->checked[off])
+		return true;
+	ctx->checked[off] = 1;
+
+	ctx->nreads++;
+	if (!EEP_READ(off, &word)) {
+		fprintf(stderr, "Unable to read EEPROM at 0x%04zx\n", off);
+		ctx->nbad++;
+		return false;
+	}
+
+	if (word == ctx->ref[off])
+		return true;
+
+	printf("Mismatch at 0x%04zx: 0x%04x, expected 0x%04x\n", off, word,
+	       ctx->ref[off]);
+	ctx->nbad++;
+
+	return ctx->all;
+}
+
+int act_eep_verify(struct atheepmgr *aem, int argc, char *argv[])
+{
+	struct verify_ctx __ctx = {0}, *ctx = &__ctx;
+	const struct eepmap_area *area;
+	const struct eepmap *eepmap;
+	struct cont_info info;
+	uint16_t *buf;
+	bool prio = false;
+	size_t off;
+	int i, ret;
+
+	if (argc < 1) {
+		fprintf(stderr, "Reference image file is not specified, aborting\n");
+		return -EINVAL;
+	}
+
+	for (i = 1; i < argc; ++i) {
+		if (strcasecmp(argv[i], "all") == 0) {
+			ctx->all = true;
+		} else if (strcasecmp(argv[i], "prio") == 0) {
+			prio = true;
+		} else {
+			fprintf(stderr, "Unknown verification option -- %s\n",
+				argv[i]);
+			return -EINVAL;
+		}
+	}
+
+	ret = cont_load_image(argv[0], &info, &buf, &ctx->len);
+	if (ret)
+		return ret;
+	ctx->ref = buf;
+
+	ctx->checked = calloc(ctx->len ? ctx->len : 1, 1);
+	if (!ctx->checked) {
+		fprintf(stderr, "Unable to allocate memory for verification\n");
+		free(buf);
+		return -ENOMEM;
+	}
+
+	if (info.eepmap)
+		aem->eep_io_swap = info.io_swap;
+	else
+		eep_detect_io_swap(aem, buf, ctx->len);
+
+	/* Check the most sensitive areas first */
+	eepmap = info.eepmap ? info.eepmap : aem->eepmap;
+	if (prio && !eepmap)
+		printf("EEPROM map type is unknown, priority check disabled\n");
+	else if (prio && eepmap->prio_areas)
+		for (area = eepmap->prio_areas; area->len; ++area)
+			for (off = area->off; off < area->off + area->len; ++off)
+				if (!verify_word(aem, ctx, off))
+					goto done;
+
+	for (off = 0; off < ctx->len; ++off)
+		if (!verify_word(aem, ctx, off))
+			break;
+
+done:
+	if (ctx->nbad)
+		printf("Verification FAILED (%d mismatch(es), %d word(s) read)\n",
+		       ctx->nbad, ctx->nreads);
+	else
+		printf("Verification passed (%d word(s) read)\n", ctx->nreads);
+
+	free(ctx->checked);
+	free(buf);
+
+	return ctx->nbad ? -EBADMSG : 0;
+}